@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "src/big_divisor.h"
+#include "src/big_integer.h"
+#include "src/big_integer_view.h"
+#include "src/division.h"
+#include "src/exponentiation.h"
+#include "src/montgomery.h"
+#include "src/multiplication.h"
+#include "src/serialization.h"
+
+namespace
+{
+    std::mt19937 rng(20180602);
+
+    std::vector<limb_t> random_limbs(size_t n)
+    {
+        std::vector<limb_t> v(n);
+        for (auto& x : v)
+            for (unsigned bits = 0; bits < LIMB_BITS; bits += 32)
+                x = (x << 16u << 16u) | rng();
+        v.back() |= 1u;
+        return v;
+    }
+
+    big_integer random_number(size_t n)
+    {
+        big_integer x;
+        for (limb_t limb : random_limbs(n))
+            for (unsigned bits = LIMB_BITS; bits != 0; bits -= 16)
+                x = (x << 16) + (int) ((limb >> (bits - 16)) & 0xFFFFu);
+        return x;
+    }
+
+    // Wall time of one call in microseconds: calls are timed in batches of at
+    // least a millisecond for 200ms and the fastest batch wins, which keeps
+    // the numbers stable on a loaded machine.
+    double time_per_call(std::function<void()> const& f)
+    {
+        typedef std::chrono::steady_clock clock;
+        typedef std::chrono::duration<double, std::micro> micro;
+        size_t batch = 1;
+        while (true)
+        {
+            auto start = clock::now();
+            for (size_t i = 0; i != batch; ++i)
+                f();
+            if (micro(clock::now() - start).count() >= 1000)
+                break;
+            batch *= 2;
+        }
+        double best = 1e300;
+        auto deadline = clock::now() + std::chrono::milliseconds(200);
+        do
+        {
+            auto start = clock::now();
+            for (size_t i = 0; i != batch; ++i)
+                f();
+            best = std::min(best, micro(clock::now() - start).count() / batch);
+        } while (clock::now() < deadline);
+        return best;
+    }
+
+    void bench_multiplication()
+    {
+        std::printf("multiplication, balanced operands (us per product)\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "limbs", "schoolbook", "karatsuba", "toom-3", "toom-4");
+        for (size_t n : {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 2048, 4096})
+        {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<limb_t> r(2 * n);
+            double school = time_per_call([&] { mul_schoolbook(r.data(), a.data(), n, b.data(), n); });
+            double karatsuba = time_per_call([&] { mul_karatsuba(r.data(), a.data(), n, b.data(), n); });
+            double toom3 = time_per_call([&] { mul_toom(r.data(), a.data(), n, 3, b.data(), n, 3); });
+            double toom4 = time_per_call([&] { mul_toom(r.data(), a.data(), n, 4, b.data(), n, 4); });
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", n, school, karatsuba, toom3, toom4);
+        }
+        std::printf("\n");
+
+        std::printf("multiplication, n x 2n/3 operands (us per product)\n");
+        std::printf("%8s %12s %12s %12s\n", "limbs", "multiply", "toom-2.5", "toom-4x3");
+        for (size_t n : {192, 384, 768, 1536, 3072})
+        {
+            size_t m = 2 * n / 3;
+            auto a = random_limbs(n), b = random_limbs(m);
+            std::vector<limb_t> r(n + m);
+            double best = time_per_call([&] { multiply(r.data(), a.data(), n, b.data(), m); });
+            double toom32 = time_per_call([&] { mul_toom(r.data(), a.data(), n, 3, b.data(), m, 2); });
+            double toom43 = time_per_call([&] { mul_toom(r.data(), a.data(), n, 4, b.data(), m, 3); });
+            std::printf("%8zu %12.2f %12.2f %12.2f\n", n, best, toom32, toom43);
+        }
+        std::printf("\n");
+
+        std::printf("multiplication, large balanced operands (us per product)\n");
+        std::printf("%8s %12s %12s\n", "limbs", "toom-4", "ntt");
+        for (size_t n : {1024, 2048, 3072, 4096, 6144, 8192, 16384, 65536})
+        {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<limb_t> r(2 * n);
+            double toom4 = time_per_call([&] { mul_toom(r.data(), a.data(), n, 4, b.data(), n, 4); });
+            double ntt = time_per_call([&] { mul_ntt(r.data(), a.data(), n, b.data(), n); });
+            std::printf("%8zu %12.2f %12.2f\n", n, toom4, ntt);
+        }
+        std::printf("\n");
+    }
+
+    void bench_squaring()
+    {
+        std::printf("squaring against multiplying distinct operands (us per product)\n");
+        std::printf("%8s %12s %12s %12s %12s %12s\n", "limbs", "mul school", "sqr school", "mul karat", "sqr karat",
+                    "multiply/sqr");
+        for (size_t n : {16, 32, 64, 96, 128, 256, 1024, 4096, 16384})
+        {
+            auto a = random_limbs(n), b = a;
+            std::vector<limb_t> r(2 * n);
+            auto clock = [&](std::function<void()> const& f) { return n > 1024 ? 0.0 : time_per_call(f); };
+            double mul_school = clock([&] { mul_schoolbook(r.data(), a.data(), n, b.data(), n); });
+            double sqr_school = clock([&] { sqr_schoolbook(r.data(), a.data(), n); });
+            double mul_karat = clock([&] { mul_karatsuba(r.data(), a.data(), n, b.data(), n); });
+            double sqr_karat = clock([&] { sqr_karatsuba(r.data(), a.data(), n); });
+            double ratio = time_per_call([&] { multiply(r.data(), a.data(), n, b.data(), n); })
+                           / time_per_call([&] { square(r.data(), a.data(), n); });
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f %12.2f\n", n, mul_school, sqr_school, mul_karat, sqr_karat,
+                        ratio);
+        }
+        std::printf("\n");
+    }
+
+    void bench_division()
+    {
+        std::printf("division of 2n by n limbs (us per division)\n");
+        std::printf("%8s %12s %12s\n", "limbs", "schoolbook", "divmod");
+        for (size_t n : {16, 32, 48, 64, 96, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768})
+        {
+            auto a = random_limbs(2 * n), b = random_limbs(n);
+            std::vector<limb_t> q(n + 1), r(n);
+            big_integer x = random_number(2 * n), y = random_number(n);
+            auto clock = [&](std::function<void()> const& f) { return n > 8192 ? 0.0 : time_per_call(f); };
+            double school = clock([&] { div_schoolbook(q.data(), r.data(), a.data(), 2 * n, b.data(), n); });
+            double best = time_per_call([&] { divmod(x, y); });
+            std::printf("%8zu %12.2f %12.2f\n", n, school, best);
+        }
+        std::printf("\n");
+    }
+
+    void bench_divisor()
+    {
+        std::printf("division of 2n by the same n limbs, prepared divisor against divmod (us per division)\n");
+        std::printf("%8s %12s %12s\n", "limbs", "divmod", "big_divisor");
+        for (size_t n : {1, 2, 4, 8, 16, 32, 64, 96, 128, 256, 512, 768, 1024, 2048, 4096})
+        {
+            big_integer x = random_number(2 * n), y = random_number(n);
+            big_divisor prepared(y);
+            double plain = time_per_call([&] { divmod(x, y); });
+            double fast = time_per_call([&] { prepared.divmod(x); });
+            std::printf("%8zu %12.3f %12.3f\n", n, plain, fast);
+        }
+        std::printf("\n");
+    }
+
+    void bench_montgomery()
+    {
+        std::printf("modular multiplication (us per product)\n");
+        std::printf("%8s %12s %12s %12s\n", "bits", "operator%", "big_divisor", "montgomery");
+        for (size_t bits : {1024, 2048, 4096, 8192})
+        {
+            size_t n = bits / LIMB_BITS;
+            big_integer modulus = random_number(n);
+            montgomery_context context(modulus);
+            big_divisor prepared(modulus);
+            big_integer a = random_number(n) % modulus, b = random_number(n) % modulus;
+            big_integer x = context.to_montgomery(a), y = context.to_montgomery(b);
+            double plain = time_per_call([&] { a * b % modulus; });
+            double barrett = time_per_call([&] { prepared.mod(a * b); });
+            double montgomery = time_per_call([&] { context.mul(x, y); });
+            std::printf("%8zu %12.2f %12.2f %12.2f\n", bits, plain, barrett, montgomery);
+        }
+        std::printf("\n");
+    }
+
+    void bench_powmod()
+    {
+        std::printf("modular exponentiation with a full-size exponent (ms per call)\n");
+        std::printf("%8s %12s %12s %12s %12s\n", "bits", "operator%", "montgomery", "powmod", "const-time");
+        for (size_t bits : {1024, 2048, 4096})
+        {
+            size_t n = bits / LIMB_BITS;
+            big_integer modulus = random_number(n), base = random_number(n) % modulus, exponent = random_number(n);
+            montgomery_context context(modulus);
+            big_integer x = context.to_montgomery(base);
+            double plain = time_per_call([&] {
+                big_integer result = 1, power = base;
+                for (big_integer e = exponent; e != 0; e >>= 1)
+                {
+                    if ((e & 1) != 0)
+                        result = result * power % modulus;
+                    power = power * power % modulus;
+                }
+            });
+            double binary = time_per_call([&] { context.pow(x, exponent); });
+            double window = time_per_call([&] { powmod(base, exponent, modulus); });
+            double fixed = time_per_call([&] { powmod_constant_time(base, exponent, modulus); });
+            std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", bits, plain / 1000, binary / 1000, window / 1000,
+                        fixed / 1000);
+        }
+        std::printf("\n");
+    }
+
+    void bench_pow()
+    {
+        std::printf("10^k (us per power)\n");
+        std::printf("%8s %12s %12s\n", "k", "repeated", "pow");
+        for (unsigned k : {100, 1000, 10000, 100000})
+        {
+            double repeated = k > 10000 ? 0.0 : time_per_call([&] {
+                big_integer x = 1;
+                for (unsigned i = 0; i != k; ++i)
+                    x *= 10;
+            });
+            double power = time_per_call([&] { pow(big_integer(10), k); });
+            std::printf("%8u %12.2f %12.2f\n", k, repeated, power);
+        }
+        std::printf("\n");
+    }
+
+    void bench_to_string()
+    {
+        std::printf("string conversion (ms per call)\n");
+        std::printf("%10s %12s %12s %12s %12s %12s\n", "limbs", "to_string", "to_chars", "parse", "to hex",
+                    "from hex");
+        for (size_t n : {10, 30, 100, 300, 1000, 10000, 100000})
+        {
+            big_integer x = random_number(n);
+            std::string s = x.to_string(), hex = x.to_string(16);
+            std::vector<char> buffer(max_chars(x, 10));
+            double print = time_per_call([&] { x.to_string(); });
+            double chars = time_per_call([&] { to_chars(buffer.data(), buffer.data() + buffer.size(), x); });
+            double parse = time_per_call([&] { big_integer{s}; });
+            double print_hex = time_per_call([&] { x.to_string(16); });
+            double parse_hex = time_per_call([&] { from_string(hex, 16); });
+            std::printf("%10zu %12.3f %12.3f %12.3f %12.3f %12.3f\n", n, print / 1000, chars / 1000, parse / 1000,
+                        print_hex / 1000, parse_hex / 1000);
+        }
+        std::printf("\n");
+    }
+
+    void bench_serialize()
+    {
+        std::printf("binary serialization (us per call)\n");
+        std::printf("%10s %12s %12s %12s %12s %12s %12s\n", "limbs", "to_string", "parse", "serialize",
+                    "deserialize", "export be", "import be");
+        for (size_t n : {1, 10, 100, 1000, 10000})
+        {
+            big_integer x = random_number(n), y;
+            std::string s = x.to_string();
+            std::vector<unsigned char> buffer(serialized_size(x));
+            double print = time_per_call([&] { x.to_string(); });
+            double parse = time_per_call([&] { big_integer{s}; });
+            double write = time_per_call([&] { serialize(buffer.data(), x); });
+            double read = time_per_call([&] { deserialize(buffer.data(), buffer.data() + buffer.size(), y); });
+            double exported = time_per_call([&] { export_bytes(buffer.data(), x, 8, endian::big, endian::big); });
+            size_t count = export_bytes(buffer.data(), x, 8, endian::big, endian::big);
+            double imported = time_per_call([&] { import_bytes(buffer.data(), count, 8, endian::big, endian::big); });
+            std::printf("%10zu %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f\n", n, print, parse, write, read, exported,
+                        imported);
+        }
+        std::printf("\n");
+    }
+
+    void bench_table()
+    {
+        std::printf("loading a table of 100000 values (ms)\n");
+        std::printf("%10s %12s %12s %12s\n", "limbs", "parse", "open", "open + scan");
+        for (size_t n : {4, 32})
+        {
+            std::vector<big_integer> values;
+            std::vector<std::string> text;
+            for (size_t i = 0; i != 100000; ++i)
+            {
+                values.push_back(random_number(n));
+                text.push_back(values.back().to_string());
+            }
+            char const* path = "big_integer_benchmark_table.bin";
+            big_integer_table::write(path, values);
+            double parse = time_per_call([&] {
+                std::vector<big_integer> parsed;
+                for (auto const& s : text)
+                    parsed.emplace_back(s);
+            });
+            double open = time_per_call([&] { big_integer_table table(path); });
+            double scan = time_per_call([&] {
+                big_integer_table table(path);
+                limb_t sum = 0;
+                for (size_t i = 0; i != table.size(); ++i)
+                    sum += table[i].limbs()[0];
+                if (sum == 1)
+                    std::printf(" ");
+            });
+            std::printf("%10zu %12.3f %12.3f %12.3f\n", n, parse / 1000, open / 1000, scan / 1000);
+            std::remove(path);
+        }
+        std::printf("\n");
+    }
+
+    struct benchmark
+    {
+        char const* name;
+        void (*run)();
+    };
+
+    benchmark const benchmarks[] = {
+        {"mul", bench_multiplication},
+        {"sqr", bench_squaring},
+        {"div", bench_division},
+        {"divisor", bench_divisor},
+        {"montgomery", bench_montgomery},
+        {"powmod", bench_powmod},
+        {"pow", bench_pow},
+        {"to_string", bench_to_string},
+        {"serialize", bench_serialize},
+        {"table", bench_table},
+    };
+}
+
+// Runs every benchmark, or only the ones named on the command line.
+int main(int argc, char** argv)
+{
+    for (auto const& b : benchmarks)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            selected |= std::strcmp(argv[i], b.name) == 0;
+        if (selected)
+            b.run();
+    }
+}
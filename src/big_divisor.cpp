@@ -0,0 +1,80 @@
+#include "big_divisor.h"
+#include "division.h"
+#include <algorithm>
+#include <cassert>
+
+typedef limb_t ui;
+
+typedef data uint_array;
+
+big_divisor::big_divisor(big_integer const& divisor) : value(divisor), shift(0), inverse(0) {
+    assert(!divisor.is_zero());
+    ui top = divisor.digits.back();
+    while (((top << (ui) shift) >> (LIMB_BITS - 1)) == 0) {
+        ++shift;
+    }
+    big_integer magnitude = big_integer(1, divisor.digits) << shift;
+    scaled = magnitude.digits;
+    inverse = reciprocal_word(scaled.back());
+    if (scaled.size() >= BARRETT_THRESHOLD) {
+        barrett = reciprocal(magnitude, scaled.size());
+    }
+}
+
+big_integer big_divisor::div(big_integer const& a) const {
+    return divmod(a).first;
+}
+
+big_integer big_divisor::mod(big_integer const& a) const {
+    return divmod(a).second;
+}
+
+std::pair<big_integer, big_integer> big_divisor::divmod(big_integer const& a) const {
+    size_t n = a.digits.size(), m = scaled.size();
+    if (m == 1) {
+        uint_array quotient(n);
+        ui remainder = div_word_preinv(quotient.begin(), a.digits.begin(), n, scaled[0], inverse, shift);
+        return {big_integer(a.sign * value.sign, quotient), big_integer(a.sign, uint_array(1, remainder))};
+    }
+    if (a.less_than(value)) {
+        return {big_integer(0), a};
+    }
+    if (m >= BURNIKEL_ZIEGLER_THRESHOLD && n >= m + BURNIKEL_ZIEGLER_THRESHOLD) {
+        // A short quotient stays with the schoolbook loop below, which costs
+        // only (n - m + 1) * m; a long one goes to a subquadratic method.
+        return m >= BARRETT_THRESHOLD ? divmod_barrett(a) : ::divmod(a, value);
+    }
+    uint_array quotient(n - m + 1), remainder(m);
+    div_schoolbook_scaled(quotient.begin(), remainder.begin(), a.digits.begin(), n, scaled.begin(), m, shift, inverse);
+    return {big_integer(a.sign * value.sign, quotient), big_integer(a.sign, remainder)};
+}
+
+big_integer const& big_divisor::divisor() const {
+    return value;
+}
+
+// Schoolbook division in base B^m, B = 2^LIMB_BITS, where each 2m by m limb step
+// estimates its quotient from the top m + 1 limbs and the reciprocal
+// floor(B^(2m) / scaled); the estimate is at most two too small.
+std::pair<big_integer, big_integer> big_divisor::divmod_barrett(big_integer const& a) const {
+    size_t m = scaled.size();
+    big_integer d(1, scaled);
+    big_integer x = big_integer(1, a.digits) << shift;
+    size_t blocks = (x.digits.size() + m - 1) / m;
+    uint_array quotient(blocks * m, 0);
+    big_integer remainder(0);
+    for (size_t i = blocks; i--;) {
+        big_integer block = (remainder << (int) (LIMB_BITS * m)) + x.slice(i * m, m);
+        big_integer q = (block.slice(m - 1, m + 1) * barrett) >> (int) (LIMB_BITS * (m + 1));
+        remainder = block - q * d;
+        while (remainder >= d) {
+            remainder -= d;
+            ++q;
+        }
+        std::copy(q.digits.begin(), q.digits.end(), quotient.begin() + i * m);
+    }
+    remainder >>= shift;
+    remainder.sign = a.sign;
+    remainder.normalize();
+    return {big_integer(a.sign * value.sign, quotient), remainder};
+}
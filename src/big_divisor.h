@@ -0,0 +1,33 @@
+#ifndef BIGINT_BIG_DIVISOR_H
+#define BIGINT_BIG_DIVISOR_H
+
+#include "big_integer.h"
+#include "data.h"
+#include <utility>
+
+// A divisor prepared once for dividing many values by it: the scaling shift
+// and the scaled divisor are kept, together with the Moller-Granlund
+// reciprocal of its top limb and, from BARRETT_THRESHOLD limbs on, a Barrett
+// reciprocal for long quotients.
+// Results match divmod(), operator/ and operator%.
+class big_divisor {
+public:
+    explicit big_divisor(big_integer const& divisor);
+
+    big_integer div(big_integer const& a) const;
+    big_integer mod(big_integer const& a) const;
+    std::pair<big_integer, big_integer> divmod(big_integer const& a) const;
+
+    big_integer const& divisor() const;
+
+private:
+    big_integer value;
+    int shift;
+    data scaled;
+    limb_t inverse;
+    big_integer barrett;
+
+    std::pair<big_integer, big_integer> divmod_barrett(big_integer const& a) const;
+};
+
+#endif //BIGINT_BIG_DIVISOR_H
@@ -1,9 +1,19 @@
 #include "big_integer.h"
+#include "multiplication.h"
+#include "division.h"
+#include "conversion.h"
+#include <algorithm>
 #include <utility>
+#include <vector>
 #include <cassert>
+#include <climits>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 
-typedef unsigned int ui;
-typedef unsigned long long ull;
+typedef limb_t ui;
+typedef double_limb_t ull;
 
 typedef data uint_array;
 
@@ -25,39 +35,31 @@ big_integer::big_integer(char sign, uint_array const& digits) : sign(sign), digi
     this->normalize();
 }
 
-big_integer::big_integer(const std::string& s) {
-    size_t start = 0;
-    if (s[0] == '-') {
-        sign = -1;
-        start = 1;
-    } else {
-        sign = 1;
-    }
-    for (size_t i = start; i < s.size(); i++) {
-        mul(10);
-        add((ui) (s[i] - '0'));
-    }
-    normalize();
-}
+big_integer::big_integer(const std::string& s) : big_integer(from_string(s, 10)) {}
 
 big_integer operator+(const big_integer& a, const big_integer& b) {
     if (a.sign == b.sign) {
+        uint_array const& longer = a.digits.size() < b.digits.size() ? b.digits : a.digits;
+        uint_array const& shorter = a.digits.size() < b.digits.size() ? a.digits : b.digits;
+        size_t n = longer.size(), m = shorter.size();
+        ui const* x = longer.begin();
+        ui const* y = shorter.begin();
+        // One limb more for the carry, trimmed by normalize().
+        uint_array digits(n + 1);
+        limb_span r = digits.span();
         ui propagate = 0;
-        uint_array digits(std::max(a.digits.size(), b.digits.size()), 0);
-        for (size_t i = 0; i < digits.size(); i++) {
-            ull result = 0;
-            if (i >= b.digits.size()) {
-                result = (ull) a.digits[i] + propagate;
-            } else if (i >= a.digits.size()) {
-                result = (ull) b.digits[i] + propagate;
-            } else {
-                result = (ull) b.digits[i] + a.digits[i] + propagate;
-            }
-            propagate = (ui) (result >> 32u);
-            digits[i] = (ui) result;
+        size_t i = 0;
+        for (; i < m; i++) {
+            ull result = (ull) x[i] + y[i] + propagate;
+            r[i] = (ui) result;
+            propagate = (ui) (result >> LIMB_BITS);
+        }
+        for (; i < n; i++) {
+            ull result = (ull) x[i] + propagate;
+            r[i] = (ui) result;
+            propagate = (ui) (result >> LIMB_BITS);
         }
-        if (propagate != 0)
-            digits.push_back(propagate);
+        r[n] = propagate;
         return big_integer(a.sign, digits);
     } else if (b.sign == -1) {
         return a - big_integer(1, b.digits);
@@ -70,15 +72,17 @@ big_integer operator-(const big_integer& a, const big_integer& b) {
     if (a.sign == b.sign) {
         if (b.less_than(a)) {
             uint_array digits(a.digits);
+            limb_span r = digits.span();
+            ui const* y = b.digits.begin();
             ui propagate = 0;
             for (size_t i = 0; i < b.digits.size(); i++) {
-                ull result = (ull) a.digits[i] -
-                             (ull) b.digits[i] - propagate;
-                propagate = (ui) (a.digits[i] < (ull) b.digits[i] + propagate);
-                digits[i] = (ui) result;
+                ull result = (ull) r[i] - y[i] - propagate;
+                propagate = (ui) (r[i] < (ull) y[i] + propagate);
+                r[i] = (ui) result;
             }
-            if (propagate != 0) {
-                digits[b.digits.size()] -= propagate;
+            for (size_t i = b.digits.size(); propagate != 0; i++) {
+                propagate = (ui) (r[i] == 0);
+                r[i] -= 1;
             }
             return big_integer(a.sign, digits);
         } else if (a == b) {
@@ -96,83 +100,248 @@ big_integer operator-(const big_integer& a, const big_integer& b) {
 }
 
 big_integer operator*(const big_integer& a, const big_integer& b) {
-    uint_array digits(a.digits.size() * b.digits.size(), 0);
-    ull result;
-    ui pointer = 0;
-    ui pt_copy = 0;
-    for (ui digit : a.digits) {
-        ui propagate = 0;
-        for (ui digit1 : b.digits) {
-            result = (ull) digit * (ull) digit1
-                     + digits[pointer] + propagate;
-            digits[pointer] = (ui) result;
-            propagate = (ui) (result >> 32u);
-            ++pointer;
+    size_t n = a.digits.size(), m = b.digits.size();
+    if (a.digits.begin() == b.digits.begin() && n == m) {
+        // x * x, or two copies still sharing one buffer
+        return square(a);
+    }
+    uint_array digits(n + m, 0);
+    multiply(digits.begin(), a.digits.begin(), n, b.digits.begin(), m);
+    return big_integer(a.sign * b.sign, digits);
+}
+
+big_integer square(const big_integer& a) {
+    size_t n = a.digits.size();
+    uint_array digits(2 * n, 0);
+    square(digits.begin(), a.digits.begin(), n);
+    return big_integer(1, digits);
+}
+
+big_integer pow(const big_integer& a, uint64_t exponent) {
+    char sign = a.sign < 0 && exponent % 2 == 1 ? (char) -1 : (char) 1;
+    size_t n = a.digits.size();
+    ui top = a.digits.back();
+    if (exponent == 0) {
+        return big_integer(1);
+    }
+    if (n == 1 && top <= 1) {
+        return big_integer(sign, a.digits);
+    }
+    size_t bits = LIMB_BITS * n;
+    while ((top >> ((bits - 1) % LIMB_BITS)) == 0) {
+        --bits;
+    }
+    if ((top & (top - 1)) == 0 && std::all_of(a.digits.begin(), a.digits.end() - 1, [](ui x) {return x == 0;})) {
+        if (exponent > (uint64_t) INT_MAX / (bits - 1)) {
+            throw std::length_error("pow: result longer than INT_MAX bits");
+        }
+        big_integer power = big_integer(1) << (int) ((bits - 1) * exponent);
+        power.sign = sign;
+        return power;
+    }
+
+    // a^k has at most bits * k bits, so neither buffer ever grows.
+    if (exponent > (uint64_t) INT_MAX / bits) {
+        throw std::length_error("pow: result longer than INT_MAX bits");
+    }
+    size_t capacity = (size_t) ((bits * exponent + LIMB_BITS - 1) / LIMB_BITS + 1);
+    uint_array current(capacity, 0), next(capacity, 0);
+    std::copy(a.digits.begin(), a.digits.end(), current.begin());
+    size_t length = n;
+    int step = 63;
+    while ((exponent >> (ui) step) == 0) {
+        --step;
+    }
+    while (step--) {
+        square(next.begin(), current.begin(), length);
+        length *= 2;
+        while (next[length - 1] == 0) {
+            --length;
         }
-        if (digits.size() <= pointer) {
-            digits.push_back(0);
+        current.swap(next);
+        if ((exponent >> (ui) step) & 1u) {
+            multiply(next.begin(), current.begin(), length, a.digits.begin(), n);
+            length += n;
+            while (next[length - 1] == 0) {
+                --length;
+            }
+            current.swap(next);
         }
-        digits[pointer] += propagate;
-        pointer = (++pt_copy);
     }
-    return big_integer(a.sign * b.sign, digits);
+    std::fill(current.begin() + length, current.end(), 0);
+    return big_integer(sign, current);
 }
 
-big_integer operator/(const big_integer& a, const big_integer& b) {
-    assert(!b.is_zero());
-    unsigned long long const MX = 4294967296u; // max unsigned int + 1
-    big_integer copy_a(a);
-    big_integer copy_b(b);
+std::pair<big_integer, big_integer> big_integer::divmod_schoolbook(const big_integer& a, const big_integer& b) {
     if (b.digits.size() == 1) {
-        big_integer ans(a);
-        ans.div(b.digits[0]);
-        ans.sign = a.sign * b.sign;
-        return ans;
+        big_integer quotient(a);
+        ui remainder = quotient.div(b.digits[0]);
+        quotient.sign = a.sign * b.sign;
+        quotient.normalize();
+        return {quotient, big_integer(a.sign, uint_array(1, remainder))};
+    }
+    if (a.less_than(b)) {
+        return {big_integer(0), a};
     }
-    copy_a.sign = copy_b.sign = 1;
-    if (copy_a < copy_b) {
+    size_t n = a.digits.size(), m = b.digits.size();
+    uint_array quotient(n - m + 1, 0), remainder(m, 0);
+    div_schoolbook(quotient.begin(), remainder.begin(), a.digits.begin(), n, b.digits.begin(), m);
+    return {big_integer(a.sign * b.sign, quotient), big_integer(a.sign, remainder)};
+}
+
+big_integer big_integer::slice(size_t from, size_t count) const {
+    from = std::min(from, digits.size());
+    count = std::min(count, digits.size() - from);
+    if (count == 0) {
         return big_integer(0);
-    } else if (copy_a == copy_b) {
-        return big_integer(1);
     }
-    auto d = (ui)(MX / (b.digits.back() + 1));
-    copy_a.mul(d);
-    copy_b.mul(d);
-    copy_a.normalize();
-    copy_b.normalize();
-    size_t sz_a = copy_a.digits.size(), sz_b = copy_b.digits.size();
-    uint_array digits(sz_a - sz_b + 1, 0);
-    big_integer dividend, divider;
-    dividend.digits.assign(sz_b + 1, 0);
-    for (size_t i = 0; i < sz_b; i++) {
-        dividend.digits[i] = copy_a.digits[sz_a - sz_b + i];
-    }
-    dividend.digits[sz_b] = 0;
-    for (size_t i = 0; i < sz_a - sz_b + 1; i++) {
-        size_t pos = sz_a - sz_b - i;
-        dividend.digits[0] = copy_a.digits[pos];
-        ull p1 = MX * (sz_b < dividend.digits.size() ? dividend.digits[sz_b] : 0);
-        ull p2 = (sz_b - 1 < dividend.digits.size() ? dividend.digits[sz_b - 1] : 0);
-        auto tmp = (ui)std::min(((p1 + p2) / copy_b.digits.back()), MX - 1);
-        divider = copy_b;
-        divider.mul(tmp);
-        while (dividend.less_than(divider)) {
-            --tmp;
-            divider.sub(copy_b);
-        }
-        dividend.sub(divider);
-        for (size_t j = sz_b; j--;) {
-            dividend.digits[j + 1] = dividend.digits[j];
-        }
-        digits[pos] = tmp;
+    uint_array part(count);
+    std::copy(digits.begin() + from, digits.begin() + from + count, part.begin());
+    return big_integer(1, part);
+}
+
+// Burnikel and Ziegler, "Fast Recursive Division", 1998. All values are
+// non-negative, b has n limbs with the top bit set and a < b * B^n.
+std::pair<big_integer, big_integer> big_integer::div_two_by_one(const big_integer& a, const big_integer& b, size_t n) {
+    if (n < BURNIKEL_ZIEGLER_THRESHOLD) {
+        return divmod_schoolbook(a, b);
     }
-    return big_integer(a.sign * b.sign, digits);
+    if (n % 2 == 1) {
+        // Pad both operands by one limb to split evenly.
+        auto qr = div_two_by_one(a << (int) LIMB_BITS, b << (int) LIMB_BITS, n + 1);
+        qr.second = qr.second.slice(1, qr.second.digits.size());
+        return qr;
+    }
+    size_t half = n / 2;
+    big_integer b1 = b.slice(half, half), b2 = b.slice(0, half);
+    auto high = div_three_by_two(a.slice(n, n), a.slice(half, half), b, b1, b2, half);
+    auto low = div_three_by_two(high.second, a.slice(0, half), b, b1, b2, half);
+    return {(high.first << (int) (LIMB_BITS * half)) + low.first, low.second};
+}
+
+// Divides a12 * B^n + a3 by b = b1 * B^n + b2, where a12 < b * B^n and
+// b1 has n limbs with the top bit set.
+std::pair<big_integer, big_integer> big_integer::div_three_by_two(const big_integer& a12, const big_integer& a3,
+                                                                  const big_integer& b, const big_integer& b1,
+                                                                  const big_integer& b2, size_t n) {
+    std::pair<big_integer, big_integer> qr;
+    if (a12.slice(n, a12.digits.size()) == b1) {
+        // The quotient would not fit in n limbs; B^n - 1 is at most two too large.
+        qr.first = (big_integer(1) << (int) (LIMB_BITS * n)) - 1;
+        qr.second = a12 - (b1 << (int) (LIMB_BITS * n)) + b1;
+    } else {
+        qr = div_two_by_one(a12, b1, n);
+    }
+    qr.second = (qr.second << (int) (LIMB_BITS * n)) + a3 - qr.first * b2;
+    while (qr.second.sign < 0) {
+        --qr.first;
+        qr.second += b;
+    }
+    return qr;
+}
+
+std::pair<big_integer, big_integer> big_integer::divmod_burnikel_ziegler(const big_integer& a, const big_integer& b) {
+    size_t n = b.digits.size();
+    int shift = 0;
+    while (((b.digits.back() << (ui) shift) >> (LIMB_BITS - 1)) == 0) {
+        ++shift;
+    }
+    big_integer scaled_a = a << shift, scaled_b = b << shift;
+    scaled_a.sign = scaled_b.sign = 1;
+
+    // Schoolbook division in base B^n, each step a 2n by n limb division.
+    size_t blocks = (scaled_a.digits.size() + n - 1) / n;
+    uint_array quotient(blocks * n, 0);
+    big_integer remainder(0);
+    for (size_t i = blocks; i--;) {
+        big_integer block = (remainder << (int) (LIMB_BITS * n)) + scaled_a.slice(i * n, n);
+        auto qr = div_two_by_one(block, scaled_b, n);
+        std::copy(qr.first.digits.begin(), qr.first.digits.end(), quotient.begin() + i * n);
+        remainder = qr.second;
+    }
+    remainder >>= shift;
+    remainder.sign = a.sign;
+    remainder.normalize();
+    return {big_integer(a.sign * b.sign, quotient), remainder};
+}
+
+// Newton iteration y' = y + y * (B^(m + k) - y * b) / B^(m + k) for a
+// non-negative b of m <= k + 2 limbs, starting from the reciprocal z of the
+// top of b at half the precision h. The result is within a few units of
+// floor(B^(m + k) / b).
+big_integer big_integer::reciprocal_approximation(const big_integer& b, size_t k) {
+    size_t m = b.digits.size();
+    if (k + 1 < NEWTON_THRESHOLD) {
+        return divmod(big_integer(1) << (int) (LIMB_BITS * (m + k)), b).first;
+    }
+    size_t h = k / 2 + 1, kept = std::min(m, h + 2);
+    big_integer z = reciprocal_approximation(b.slice(m - kept, kept), h);
+    // B^(m + h) - z * b is a few multiples of b; the limbs dropped from it
+    // move the correction by less than one.
+    size_t dropped = m + h > k + 2 ? m + h - k - 2 : 0;
+    big_integer error = ((big_integer(1) << (int) (LIMB_BITS * (m + h))) - z * b) >> (int) (LIMB_BITS * dropped);
+    big_integer correction = (z * error) >> (int) (LIMB_BITS * (m + 2 * h - k - dropped));
+    return (z << (int) (LIMB_BITS * (k - h))) + correction;
+}
+
+big_integer reciprocal(const big_integer& b, size_t precision_limbs) {
+    assert(!b.is_zero());
+    size_t m = b.digits.size(), kept = std::min(m, precision_limbs + 2);
+    big_integer divisor(1, b.digits);
+    big_integer result = big_integer::reciprocal_approximation(divisor.slice(m - kept, kept), precision_limbs);
+    big_integer remainder = (big_integer(1) << (int) (LIMB_BITS * (m + precision_limbs))) - result * divisor;
+    while (remainder.sign < 0) {
+        --result;
+        remainder += divisor;
+    }
+    while (remainder >= divisor) {
+        ++result;
+        remainder -= divisor;
+    }
+    result.sign = b.sign;
+    return result;
+}
+
+std::pair<big_integer, big_integer> big_integer::divmod_newton(const big_integer& a, const big_integer& b) {
+    size_t n = a.digits.size(), m = b.digits.size(), k = n - m + 1, kept = std::min(m, k + 2);
+    big_integer dividend(1, a.digits), divisor(1, b.digits);
+    big_integer inverse = reciprocal_approximation(divisor.slice(m - kept, kept), k);
+    // Off by a few units at most, like the reciprocal.
+    big_integer quotient = (dividend * inverse) >> (int) (LIMB_BITS * (n + 1));
+    big_integer remainder = dividend - quotient * divisor;
+    while (remainder.sign < 0) {
+        --quotient;
+        remainder += divisor;
+    }
+    while (remainder >= divisor) {
+        ++quotient;
+        remainder -= divisor;
+    }
+    quotient.sign = a.sign * b.sign;
+    quotient.normalize();
+    remainder.sign = a.sign;
+    remainder.normalize();
+    return {quotient, remainder};
+}
+
+std::pair<big_integer, big_integer> divmod(const big_integer& a, const big_integer& b) {
+    assert(!b.is_zero());
+    size_t n = a.digits.size(), m = b.digits.size();
+    if (m >= NEWTON_THRESHOLD && n >= m + NEWTON_THRESHOLD) {
+        return big_integer::divmod_newton(a, b);
+    }
+    if (m >= BURNIKEL_ZIEGLER_THRESHOLD && n >= m + BURNIKEL_ZIEGLER_THRESHOLD) {
+        return big_integer::divmod_burnikel_ziegler(a, b);
+    }
+    return big_integer::divmod_schoolbook(a, b);
+}
+
+big_integer operator/(const big_integer& a, const big_integer& b) {
+    return divmod(a, b).first;
 }
 
 big_integer operator%(const big_integer& a, const big_integer& b) {
-    big_integer ans = a - a / b * b;
-    ans.normalize();
-    return ans;
+    return divmod(a, b).second;
 }
 
 big_integer operator&(const big_integer& a, const big_integer& b) {
@@ -192,23 +361,22 @@ big_integer operator<<(const big_integer& a, int b) {
     if (b == 0) {
         return a;
     }
-    size_t cnt = (ui)b / 32;
-    uint_array digits(a.digits.size() + cnt, 0);
-    for (size_t i = 0; i < a.digits.size(); ++i) {
-        digits[i + cnt] = a.digits[i];
-    }
-    b %= 32;
+    size_t cnt = (ui)b / LIMB_BITS;
+    b %= LIMB_BITS;
+    // One limb more for the bits shifted out of the top, trimmed by normalize().
+    uint_array digits(a.digits.size() + cnt + 1, 0);
+    limb_span r = digits.span();
+    ui const* x = a.digits.begin();
     if (b > 0) {
-        ull propagate = 0;
-        ull result = 0;
-        for (size_t i = cnt; i < digits.size(); ++i) {
-            result = ((ull) digits[i] << (ui)b) + propagate;
-            digits[i] = (ui)result;
-            propagate = (ui)(result >> 32u);
-        }
-        if (propagate != 0) {
-            digits.push_back((ui)propagate);
+        ui propagate = 0;
+        for (size_t i = 0; i < a.digits.size(); ++i) {
+            ull result = ((ull) x[i] << (ui)b) + propagate;
+            r[i + cnt] = (ui)result;
+            propagate = (ui)(result >> LIMB_BITS);
         }
+        r[a.digits.size() + cnt] = propagate;
+    } else {
+        std::copy(x, x + a.digits.size(), r.begin() + cnt);
     }
     return big_integer(a.sign, digits);
 }
@@ -224,21 +392,21 @@ big_integer operator>>(const big_integer& a, int b) {
         copy_a.sign = -1;
         return copy_a;
     }
-    size_t cnt = (ui)b / 32;
-    uint_array digits(a.digits.size() - cnt);
-    for (size_t i = cnt; i < a.digits.size(); ++i) {
-        digits[i - cnt] = a.digits[i];
+    size_t cnt = (ui)b / LIMB_BITS;
+    if (cnt >= a.digits.size()) {
+        return big_integer(0);
     }
-    b %= 32;
+    uint_array digits(a.digits.size() - cnt);
+    limb_span r = digits.span();
+    ui const* x = a.digits.begin() + cnt;
+    b %= LIMB_BITS;
     if (b > 0) {
-        ull propagate = 0;
-        ull result = 0;
-        for (size_t i = digits.size(); i--;) {
-            ui tmp = digits[i] & ((1u << (ui)b) - 1);
-            result = (digits[i] >> (ui)b);
-            digits[i] = (ui)(result + (propagate << (ui)(32 - b)));
-            propagate = tmp;
+        for (size_t i = 0; i + 1 < r.size(); ++i) {
+            r[i] = (x[i] >> (ui)b) | (x[i + 1] << (ui)(LIMB_BITS - b));
         }
+        r[r.size() - 1] = x[r.size() - 1] >> (ui)b;
+    } else {
+        std::copy(x, x + r.size(), r.begin());
     }
     big_integer ans(1, digits);
     return ans;
@@ -297,16 +465,232 @@ big_integer &big_integer::operator>>=(int b) {
     return *this;
 }
 
-std::ostream& operator<<(std::ostream& stream, big_integer& b) {
-    stream << b.to_string() << std::endl;
+static char const digit_chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static size_t bit_length(uint_array const& digits) {
+    size_t bits = LIMB_BITS * digits.size();
+    while (bits > 0 && (digits.begin()[(bits - 1) / LIMB_BITS] >> ((bits - 1) % LIMB_BITS)) == 0) {
+        --bits;
+    }
+    return bits;
+}
+
+// The value of a digit in bases up to 36 in either case, 36 for anything else.
+static int digit_value(char c) {
+    if ('0' <= c && c <= '9') {
+        return c - '0';
+    }
+    if ('a' <= c && c <= 'z') {
+        return c - 'a' + 10;
+    }
+    if ('A' <= c && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    return 36;
+}
+
+static int power_of_two_width(int base) {
+    int width = 0;
+    while ((1 << width) < base) {
+        ++width;
+    }
+    return (1 << width) == base ? width : 0;
+}
+
+// Characters on their way to a stream buffer, handed to sputn() a block at a
+// time. begin() runs once the digit count is known, before the first digit:
+// it pads on the right-adjusted and internal sides and writes the prefix.
+struct big_integer::digit_sink {
+    std::ostream& stream;
+    std::string const& prefix;
+    bool upper;
+    bool ok = true;
+    std::streamsize padding = 0;
+    size_t used = 0;
+    char block[1024];
+
+    digit_sink(std::ostream& stream, std::string const& prefix, bool upper)
+            : stream(stream), prefix(prefix), upper(upper) {}
+
+    void put(char const* chars, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            char c = chars[i];
+            append(upper && 'a' <= c && c <= 'z' ? (char) (c - 'a' + 'A') : c, 1);
+        }
+    }
+
+    void append(char c, size_t count) {
+        for (; count > 0; --count) {
+            if (used == sizeof block) {
+                flush();
+            }
+            block[used++] = c;
+        }
+    }
+
+    void flush() {
+        ok = ok && stream.rdbuf()->sputn(block, (std::streamsize) used) == (std::streamsize) used;
+        used = 0;
+    }
+
+    void begin(size_t digits) {
+        auto length = (std::streamsize) (prefix.size() + digits);
+        padding = std::max(stream.width() - length, (std::streamsize) 0);
+        std::ios_base::fmtflags adjust = stream.flags() & std::ios_base::adjustfield;
+        if (adjust != std::ios_base::left && adjust != std::ios_base::internal) {
+            append(stream.fill(), (size_t) padding);
+        }
+        put(prefix.data(), prefix.size());
+        if (adjust == std::ios_base::internal) {
+            append(stream.fill(), (size_t) padding);
+        }
+    }
+
+    void finish() {
+        if ((stream.flags() & std::ios_base::adjustfield) == std::ios_base::left) {
+            append(stream.fill(), (size_t) padding);
+        }
+        flush();
+    }
+};
+
+std::ostream& operator<<(std::ostream& stream, const big_integer& b) {
+    std::ostream::sentry sentry(stream);
+    if (!sentry) {
+        return stream;
+    }
+    std::ios_base::fmtflags flags = stream.flags();
+    std::ios_base::fmtflags basefield = flags & std::ios_base::basefield;
+    int base = basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+
+    std::string prefix;
+    if (b.sign < 0) {
+        prefix = "-";
+    } else if (flags & std::ios_base::showpos) {
+        prefix = "+";
+    }
+    // Like the built-in integers, zero gets no base prefix.
+    if ((flags & std::ios_base::showbase) && base == 16 && !b.is_zero()) {
+        prefix += flags & std::ios_base::uppercase ? "0X" : "0x";
+    } else if ((flags & std::ios_base::showbase) && base == 8 && !b.is_zero()) {
+        prefix += "0";
+    }
+
+    big_integer::digit_sink sink(stream, prefix, (flags & std::ios_base::uppercase) != 0);
+    size_t bits = bit_length(b.digits);
+    if (int width = power_of_two_width(base)) {
+        // Each digit is a slice of width bits, possibly spanning two limbs.
+        ui const* limbs = b.digits.begin();
+        size_t count = std::max((bits + width - 1) / width, (size_t) 1);
+        sink.begin(count);
+        for (size_t i = count; i--;) {
+            size_t offset = i * width, limb = offset / LIMB_BITS, shift = offset % LIMB_BITS;
+            ui value = limbs[limb] >> shift;
+            if (shift + width > LIMB_BITS && limb + 1 < b.digits.size()) {
+                value |= limbs[limb + 1] << (LIMB_BITS - shift);
+            }
+            char digit = digit_chars[value & (ui) (base - 1)];
+            sink.put(&digit, 1);
+        }
+    } else {
+        // Split as to_chars() does, but the leaves go out highest first.
+        big_integer magnitude(1, b.digits);
+        size_t chunk = radix_chunk_digits((ui) base), length = max_chars(magnitude, base);
+        int level = -1;
+        while ((chunk << (ui) (level + 1)) < length) {
+            ++level;
+        }
+        std::vector<big_integer> powers;
+        if (level >= 0 && b.digits.size() >= TO_STRING_THRESHOLD) {
+            powers = radix_power_cache::instance().powers((ui) base, (size_t) (level + 1));
+        }
+        magnitude.stream_digits(sink, powers, level, base, false, 0);
+    }
+    sink.finish();
+    stream.width(0);
+    if (!sink.ok) {
+        stream.setstate(std::ios_base::badbit);
+    }
     return stream;
 }
 
 
+// Digits go from the stream buffer into fixed blocks of c * 2^6 digits, c
+// digits filling a limb. Parsed blocks are merged like a binary counter: two
+// values of c * 2^k digits become one of c * 2^(k + 1) through a cached
+// power, so the work stays subquadratic and memory proportional to the result.
 std::istream& operator>>(std::istream& stream, big_integer& b) {
-    std::string s;
-    stream >> s;
-    b = big_integer(s);
+    std::istream::sentry sentry(stream);
+    if (!sentry) {
+        return stream;
+    }
+    std::ios_base::fmtflags basefield = stream.flags() & std::ios_base::basefield;
+    int base = basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+    typedef std::istream::traits_type traits;
+    std::streambuf* buffer = stream.rdbuf();
+    int c = buffer->sgetc();
+
+    bool negative = c == '-', any = false;
+    if (c == '-' || c == '+') {
+        c = buffer->snextc();
+    }
+    if (base == 16 && c == '0') {
+        // A leading zero is a digit in itself unless an x follows.
+        any = true;
+        c = buffer->snextc();
+        if (c == 'x' || c == 'X') {
+            any = false;
+            c = buffer->snextc();
+        }
+    }
+
+    size_t chunk = radix_chunk_digits((ui) base), block_size = chunk << 6u;
+    int width = power_of_two_width(base);
+    auto scale = [width](big_integer const& high, size_t digits, big_integer const& power) {
+        return width != 0 ? high << (int) (width * digits) : high * power;
+    };
+    std::vector<std::pair<big_integer, size_t>> blocks;
+    std::string block;
+    block.reserve(block_size);
+    while (c != traits::eof() && digit_value((char) c) < base) {
+        any = true;
+        block.push_back((char) c);
+        if (block.size() == block_size) {
+            big_integer value;
+            from_chars(block.data(), block.data() + block.size(), value, base);
+            size_t level = 6;
+            while (!blocks.empty() && blocks.back().second == level) {
+                big_integer power = width != 0 ? big_integer() : radix_power_cache::instance().power((ui) base, level);
+                value = scale(blocks.back().first, chunk << level, power) + value;
+                blocks.pop_back();
+                ++level;
+            }
+            blocks.emplace_back(value, level);
+            block.clear();
+        }
+        c = buffer->snextc();
+    }
+    if (c == traits::eof()) {
+        stream.setstate(std::ios_base::eofbit);
+    }
+    if (!any) {
+        b = 0;
+        stream.setstate(std::ios_base::failbit);
+        return stream;
+    }
+
+    big_integer result;
+    if (!block.empty()) {
+        from_chars(block.data(), block.data() + block.size(), result, base);
+    }
+    size_t digits = block.size();
+    while (!blocks.empty()) {
+        big_integer power = width != 0 ? big_integer() : pow(big_integer(base), digits);
+        result = scale(blocks.back().first, digits, power) + result;
+        digits += chunk << blocks.back().second;
+        blocks.pop_back();
+    }
+    b = negative ? -result : result;
     return stream;
 }
 
@@ -371,7 +755,7 @@ big_integer big_integer::to_signed() {
 
 
 big_integer big_integer::to_unsigned() {
-    if ((this->digits.back() >> 31u) & 1u) {
+    if ((this->digits.back() >> (LIMB_BITS - 1)) & 1u) {
         sign = -1;
         *this += 1;
         reverse_bits();
@@ -392,6 +776,11 @@ big_integer bitwise_operator(const big_integer& a, const big_integer& b,
                              const std::function<ui(ui, ui)>& op) {
     big_integer copy_b(b);
     big_integer copy_a(a);
+    // Room for the padding and the sign limb of to_signed(), taken while
+    // unsharing from a and b.
+    size_t n = std::max(a.digits.size(), b.digits.size()) + 1;
+    copy_a.digits.reserve(n);
+    copy_b.digits.reserve(n);
     while (copy_a.digits.size() < copy_b.digits.size())
         copy_a.digits.push_back(0);
     while (copy_b.digits.size() < copy_a.digits.size())
@@ -411,24 +800,237 @@ bool big_integer::is_zero() const {
 }
 
 std::string big_integer::to_string() const {
-    if (digits.empty() || this->is_zero()) {
-        return "0";
+    return to_string(10);
+}
+
+std::string big_integer::to_string(int base) const {
+    std::string str(max_chars(*this, base), '0');
+    auto result = to_chars(&str[0], &str[0] + str.size(), *this, base);
+    str.resize((size_t) (result.ptr - str.data()));
+    return str;
+}
+
+size_t max_chars(const big_integer& a, int base) {
+    assert(2 <= base && base <= 36);
+    size_t bits = bit_length(a.digits), length = 1;
+    if (int width = power_of_two_width(base)) {
+        length = std::max(length, (bits + width - 1) / width);
+    } else {
+        // Exact unless |a| has one digit less than its bit length allows.
+        length = std::max(length, (size_t) ((double) bits / std::log2(base)) + 1);
+    }
+    return length + (a.sign < 0);
+}
+
+std::to_chars_result to_chars(char* first, char* last, const big_integer& a, int base) {
+    assert(2 <= base && base <= 36);
+    size_t need = max_chars(a, base), room = (size_t) (last - first);
+    if (room < need) {
+        // max_chars() is exact for powers of two and single digits; otherwise
+        // it is one over exactly when |a| < base^(digits - 1), and then the
+        // digits fill the room.
+        size_t digits = need - (a.sign < 0);
+        if (room + 1 < need || power_of_two_width(base) || digits == 1 ||
+            !a.less_than(pow(big_integer(base), digits - 1))) {
+            return {last, std::errc::value_too_large};
+        }
+        need = room;
+    }
+    char* out = first;
+    if (a.sign < 0) {
+        *out++ = '-';
+    }
+    size_t bits = bit_length(a.digits);
+    if (bits == 0) {
+        *out++ = '0';
+        return {out, std::errc()};
     }
-    bool flag = this->sign== -1;
-    big_integer copy(*this);
-    std::string str = "";
-    while (!(copy.is_zero())) {
-        ui dig = copy.div(10);
-        str += std::to_string(dig);
+    if (int width = power_of_two_width(base)) {
+        // Each digit is a slice of width bits, possibly spanning two limbs.
+        ui const* limbs = a.digits.begin();
+        size_t count = (bits + width - 1) / width;
+        for (size_t i = 0; i < count; ++i) {
+            size_t offset = i * width, limb = offset / LIMB_BITS, shift = offset % LIMB_BITS;
+            ui value = limbs[limb] >> shift;
+            if (shift + width > LIMB_BITS && limb + 1 < a.digits.size()) {
+                value |= limbs[limb + 1] << (LIMB_BITS - shift);
+            }
+            out[count - 1 - i] = digit_chars[value & (ui) (base - 1)];
+        }
+        return {out + count, std::errc()};
     }
-    if (flag) {
-        str += '-';
+    // The top level splits the digits into halves of c * 2^level each, c
+    // digits filling a limb. They are written right-aligned in the buffer
+    // and moved to the front.
+    size_t chunk = radix_chunk_digits((ui) base), length = need - (a.sign < 0);
+    int level = -1;
+    while ((chunk << (ui) (level + 1)) < length) {
+        ++level;
     }
-    return std::string(str.rbegin(), str.rend());
+    std::vector<big_integer> powers;
+    if (level >= 0 && a.digits.size() >= TO_STRING_THRESHOLD) {
+        powers = radix_power_cache::instance().powers((ui) base, (size_t) (level + 1));
+    }
+    char* end = first + need;
+    char* start = big_integer(1, a.digits).write_digits(end, powers, level, base, false);
+    return {std::copy(start, end, out), std::errc()};
+}
+
+// Writes this non-negative value, below (base^c)^(2^(level + 1)), as digits
+// ending just before end and returns where they start: all c * 2^(level + 1)
+// of them when padded, otherwise without leading zeros.
+char* big_integer::write_digits(char* end, std::vector<big_integer> const& powers, int level, int base,
+                                bool padded) const {
+    size_t chunk = radix_chunk_digits((ui) base);
+    if (level < 0 || digits.size() < TO_STRING_THRESHOLD) {
+        ui divisor = 1;
+        for (size_t i = 0; i < chunk; ++i) {
+            divisor *= (ui) base;
+        }
+        char* position = end;
+        big_integer rest(*this);
+        while (!rest.is_zero()) {
+            ui value = rest.div(divisor);
+            // Only the top chunk stops at its leading digit.
+            for (size_t i = 0; i < chunk && (value != 0 || !rest.is_zero()); ++i) {
+                *--position = digit_chars[value % (ui) base];
+                value /= (ui) base;
+            }
+        }
+        if (padded) {
+            char* start = end - (chunk << (ui) (level + 1));
+            std::fill(start, position, '0');
+            return start;
+        }
+        if (position == end) {
+            *--position = '0';
+        }
+        return position;
+    }
+    auto qr = divmod(*this, powers[level]);
+    if (!padded && qr.first.is_zero()) {
+        return qr.second.write_digits(end, powers, level - 1, base, false);
+    }
+    char* middle = qr.second.write_digits(end, powers, level - 1, base, true);
+    return qr.first.write_digits(middle, powers, level - 1, base, padded);
+}
+
+// write_digits() into a digit_sink, highest digits first, so only one leaf is
+// held as characters at a time. rest counts the digits that follow this
+// part; the top leaf passes its own count plus rest to sink.begin().
+void big_integer::stream_digits(digit_sink& sink, std::vector<big_integer> const& powers, int level, int base,
+                                bool padded, size_t rest) const {
+    size_t chunk = radix_chunk_digits((ui) base);
+    if (level < 0 || digits.size() < TO_STRING_THRESHOLD) {
+        // Below TO_STRING_THRESHOLD limbs, fewer than LIMB_BITS digits per limb.
+        char leaf[TO_STRING_THRESHOLD * LIMB_BITS];
+        char* end = leaf + sizeof leaf;
+        char* start = write_digits(end, powers, level, base, false);
+        auto count = (size_t) (end - start);
+        if (padded) {
+            sink.append('0', (chunk << (ui) (level + 1)) - count);
+        } else {
+            sink.begin(count + rest);
+        }
+        sink.put(start, count);
+        return;
+    }
+    auto qr = divmod(*this, powers[level]);
+    if (!padded && qr.first.is_zero()) {
+        qr.second.stream_digits(sink, powers, level - 1, base, false, rest);
+        return;
+    }
+    qr.first.stream_digits(sink, powers, level - 1, base, padded, rest + (chunk << (ui) level));
+    qr.second.stream_digits(sink, powers, level - 1, base, true, rest);
+}
+
+big_integer from_string(std::string_view s, int base) {
+    assert(2 <= base && base <= 36);
+    bool negative = !s.empty() && s[0] == '-';
+    if (!s.empty() && (s[0] == '-' || s[0] == '+')) {
+        s.remove_prefix(1);
+    }
+    assert(!s.empty() && std::all_of(s.begin(), s.end(), [base](char c) {return digit_value(c) < base;}));
+    big_integer result = big_integer::from_digits(s.data(), s.data() + s.size(), base);
+    if (negative) {
+        result.sign = -1;
+        result.normalize();
+    }
+    return result;
+}
+
+std::from_chars_result from_chars(const char* first, const char* last, big_integer& value, int base) {
+    assert(2 <= base && base <= 36);
+    bool negative = first != last && *first == '-';
+    char const* begin = first + negative;
+    char const* end = std::find_if(begin, last, [base](char c) {return digit_value(c) >= base;});
+    if (begin == end) {
+        return {first, std::errc::invalid_argument};
+    }
+    value = big_integer::from_digits(begin, end, base);
+    if (negative) {
+        value.sign = -1;
+        value.normalize();
+    }
+    return {end, std::errc()};
+}
+
+// The non-negative value of the digits [begin, end).
+big_integer big_integer::from_digits(char const* begin, char const* end, int base) {
+    auto count = (size_t) (end - begin);
+    if (int width = power_of_two_width(base)) {
+        uint_array digits((count * width + LIMB_BITS - 1) / LIMB_BITS, 0);
+        ui* limbs = digits.begin();
+        for (size_t i = 0; i < count; ++i) {
+            auto value = (ui) digit_value(end[-1 - (std::ptrdiff_t) i]);
+            size_t offset = i * width, limb = offset / LIMB_BITS, shift = offset % LIMB_BITS;
+            limbs[limb] |= value << shift;
+            if (shift + width > LIMB_BITS) {
+                limbs[limb + 1] |= value >> (LIMB_BITS - shift);
+            }
+        }
+        return big_integer(1, digits);
+    }
+    size_t chunk = radix_chunk_digits((ui) base), levels = 0;
+    while (count > chunk * FROM_STRING_THRESHOLD && (chunk << levels) < count) {
+        ++levels;
+    }
+    std::vector<big_integer> powers = radix_power_cache::instance().powers((ui) base, levels);
+    return parse_digits(begin, end, powers, base);
+}
+
+// Digits [begin, end) split as high * (base^c)^(2^k) + low, for the largest
+// k below the length with that power in powers; c digits per mul(base^c)
+// once the string is short.
+big_integer big_integer::parse_digits(char const* begin, char const* end, std::vector<big_integer> const& powers,
+                                      int base) {
+    auto length = (size_t) (end - begin);
+    size_t chunk = radix_chunk_digits((ui) base), level = powers.size();
+    while (level > 0 && (chunk << (level - 1)) >= length) {
+        --level;
+    }
+    if (level == 0 || length <= chunk * FROM_STRING_THRESHOLD) {
+        big_integer result(0);
+        size_t chunk_length = (length + chunk - 1) % chunk + 1;
+        for (char const* part = begin; part != end; part += chunk_length, chunk_length = chunk) {
+            ui value = 0, scale = 1;
+            for (char const* digit = part; digit != part + chunk_length; ++digit) {
+                value = value * (ui) base + (ui) digit_value(*digit);
+                scale *= (ui) base;
+            }
+            result.mul(scale);
+            result.add(value);
+        }
+        return result;
+    }
+    char const* middle = end - (chunk << (level - 1));
+    return parse_digits(begin, middle, powers, base) * powers[level - 1] + parse_digits(middle, end, powers, base);
 }
 
 void big_integer::normalize() {
-    while (digits.size() > 1 && digits.back() == 0) {
+    // Reading through the mutable back() would unshare the buffer.
+    data const& limbs = digits;
+    while (limbs.size() > 1 && limbs.back() == 0) {
         digits.pop_back();
     }
     if (is_zero())
@@ -436,10 +1038,11 @@ void big_integer::normalize() {
 }
 
 ui big_integer::div(const ui& b) {
+    limb_span r = digits.span();
     ull propagate = 0;
-    for (size_t i = digits.size(); i--;) {
-        ull temp = digits[i] + (propagate << 32u);
-        digits[i] = (ui) (temp / b);
+    for (size_t i = r.size(); i--;) {
+        ull temp = r[i] + (propagate << LIMB_BITS);
+        r[i] = (ui) (temp / b);
         propagate = temp % b;
     }
     normalize();
@@ -448,10 +1051,10 @@ ui big_integer::div(const ui& b) {
 
 void big_integer::mul(const ui& b) {
     ui propagate = 0;
-    for (ui& digit : digits) {
+    for (ui& digit : digits.span()) {
         ull result = (ull) digit * b + propagate;
         digit = (ui) result;
-        propagate = (ui) (result >> 32u);
+        propagate = (ui) (result >> LIMB_BITS);
     }
     if (propagate > 0) {
         digits.push_back(propagate);
@@ -460,10 +1063,10 @@ void big_integer::mul(const ui& b) {
 
 void big_integer::add(const ui& b) {
     ui propagate = b;
-    for (ui& digit : digits) {
+    for (ui& digit : digits.span()) {
         ull result = (ull) digit + propagate;
         digit = (ui) result;
-        propagate = (ui) (result >> 32u);
+        propagate = (ui) (result >> LIMB_BITS);
         if (propagate == 0) {
             break;
         }
@@ -473,24 +1076,14 @@ void big_integer::add(const ui& b) {
     }
 }
 
-void big_integer::sub(const big_integer& b) {
-    ui propagate = 0;
-    size_t i = 0;
-    for (; i < b.digits.size(); ++i) {
-        ull tmp = (ull) propagate + b.digits[i];
-        propagate = (ui) (digits[i] < tmp);
-        digits[i] -= tmp;
-    }
-    for (; propagate; ++i) {
-        propagate = (ui) (digits[i] == 0);
-        digits[i] -= 1;
-    }
-}
-
 std::string to_string(const big_integer& a) {
     return a.to_string();
 }
 
+std::string to_string(const big_integer& a, int base) {
+    return a.to_string(base);
+}
+
 bool big_integer::less_than(const big_integer &b) const {
     if (digits.size() < b.digits.size()) {
         return true;
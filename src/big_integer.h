@@ -2,12 +2,19 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <cstdlib>
 #include <algorithm>
 #include <functional>
 #include <iomanip>
+#include <utility>
+#include <cstdint>
 #include "data.h"
 
+enum class endian;
+enum class sign_format;
+
 class big_integer {
 public:
     big_integer();
@@ -49,8 +56,15 @@ public:
     friend big_integer operator+(const big_integer&, const big_integer&);
     friend big_integer operator-(const big_integer&, const big_integer&);
     friend big_integer operator*(const big_integer&, const big_integer&);
+    friend big_integer square(const big_integer&);
+    friend big_integer pow(const big_integer&, uint64_t);
+    friend big_integer reciprocal(const big_integer&, size_t);
+    friend big_integer powmod(const big_integer&, const big_integer&, const big_integer&);
+    friend big_integer powmod_constant_time(const big_integer&, const big_integer&, const big_integer&);
+
     friend big_integer operator/(const big_integer&, const big_integer&);
     friend big_integer operator%(const big_integer&, const big_integer&);
+    friend std::pair<big_integer, big_integer> divmod(const big_integer&, const big_integer&);
 
     friend big_integer operator&(const big_integer&, const big_integer&);
     friend big_integer operator|(const big_integer&, const big_integer&);
@@ -60,7 +74,22 @@ public:
     friend big_integer operator>>(const big_integer&, int);
 
     std::string to_string() const;
+    // Digits 0-9 and a-z in base 2 to 36, with a leading '-' when negative.
+    std::string to_string(int base) const;
+    friend big_integer from_string(std::string_view, int);
+    friend size_t max_chars(const big_integer&, int);
+    friend std::to_chars_result to_chars(char*, char*, const big_integer&, int);
+    friend std::from_chars_result from_chars(const char*, const char*, big_integer&, int);
+    friend std::ostream& operator<<(std::ostream&, big_integer const&);
+    friend size_t export_words(big_integer const&, size_t, sign_format);
+    friend size_t export_bytes(unsigned char*, big_integer const&, size_t, endian, endian, sign_format);
+    friend unsigned char* serialize(unsigned char*, big_integer const&);
 private:
+    friend class big_divisor;
+    friend class montgomery_context;
+    friend class big_integer_view;
+    friend class radix_power_cache;
+
     char sign;
     data digits;
 
@@ -70,12 +99,28 @@ private:
     big_integer to_signed();
     big_integer to_unsigned();
     friend big_integer bitwise_operator(const big_integer&, const big_integer&,
-                                        const std::function<unsigned int(unsigned int, unsigned int)>&);
+                                        const std::function<limb_t(limb_t, limb_t)>&);
     bool less_than(const big_integer &) const;
-    void mul(const unsigned int& number);
-    void add(const unsigned int& number);
-    unsigned int div(const unsigned int& number);
-    void sub(const big_integer& b);
+    void mul(const limb_t& number);
+    void add(const limb_t& number);
+    limb_t div(const limb_t& number);
+
+    big_integer slice(size_t from, size_t count) const;
+    char* write_digits(char* end, std::vector<big_integer> const& powers, int level, int base, bool padded) const;
+    struct digit_sink;
+    void stream_digits(digit_sink& sink, std::vector<big_integer> const& powers, int level, int base, bool padded,
+                       size_t rest) const;
+    static big_integer from_digits(char const* begin, char const* end, int base);
+    static big_integer parse_digits(char const* begin, char const* end, std::vector<big_integer> const& powers,
+                                    int base);
+    static std::pair<big_integer, big_integer> divmod_schoolbook(const big_integer&, const big_integer&);
+    static big_integer reciprocal_approximation(const big_integer&, size_t);
+    static std::pair<big_integer, big_integer> divmod_newton(const big_integer&, const big_integer&);
+    static std::pair<big_integer, big_integer> divmod_burnikel_ziegler(const big_integer&, const big_integer&);
+    static std::pair<big_integer, big_integer> div_two_by_one(const big_integer&, const big_integer&, size_t);
+    static std::pair<big_integer, big_integer> div_three_by_two(const big_integer&, const big_integer&,
+                                                                const big_integer&, const big_integer&,
+                                                                const big_integer&, size_t);
 };
 
 bool operator==(const big_integer&, const big_integer&);
@@ -85,7 +130,47 @@ bool operator>(const big_integer&, const big_integer&);
 bool operator<=(const big_integer&, const big_integer&);
 bool operator>=(const big_integer&, const big_integer&);
 
-std::string to_string(big_integer const& a);
+big_integer square(const big_integer&);
 
-std::ostream& operator<<(std::ostream&, big_integer&);
+// a^exponent, with pow(0, 0) = 1. Powers of two become a single shift;
+// otherwise binary exponentiation in two buffers sized up front for the
+// result. Throws std::length_error when the result could exceed INT_MAX
+// bits, the range of the shift operators.
+big_integer pow(const big_integer& a, uint64_t exponent);
+
+// Quotient rounded towards zero and remainder with the sign of the dividend,
+// as operator/ and operator% give them, from a single long division.
+std::pair<big_integer, big_integer> divmod(const big_integer&, const big_integer&);
+
+// floor(B^(m + precision_limbs) / |b|) with the sign of b, where B is the
+// limb base 2^LIMB_BITS and b has m limbs: the top precision_limbs + 1 limbs
+// of 1 / b. Newton iteration doubles the precision each step, so this costs a
+// few multiplications of the final size.
+big_integer reciprocal(const big_integer& b, size_t precision_limbs);
+
+std::string to_string(big_integer const& a);
+std::string to_string(big_integer const& a, int base);
+
+// Parses an optional sign and at least one digit in base 2 to 36, letters in
+// either case; anything else in s is a precondition violation. Power-of-two
+// bases place the bits of each digit directly into the limbs.
+big_integer from_string(std::string_view s, int base);
+
+// An upper bound on the characters to_chars() writes for a, sign included:
+// exact for power-of-two bases and at most one over otherwise.
+size_t max_chars(const big_integer& a, int base = 10);
+
+// std::to_chars for big_integer: digits and an optional '-', no terminator.
+// Fails with value_too_large, returning last, when [first, last) is too short.
+std::to_chars_result to_chars(char* first, char* last, const big_integer& a, int base = 10);
+
+// std::from_chars for big_integer: an optional '-' and the longest run of
+// digits in base, letters in either case. Returns the end of the digits, or
+// first with invalid_argument and value untouched when there are none.
+std::from_chars_result from_chars(const char* first, const char* last, big_integer& value, int base = 10);
+
+// Honours the basefield (dec, hex, oct), showbase, showpos, uppercase,
+// width, fill and adjustfield flags like the built-in integer inserters, and
+// never flushes.
+std::ostream& operator<<(std::ostream&, big_integer const&);
 std::istream& operator>>(std::istream&, big_integer&);
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "big_integer_view.h"
+#include "multiplication.h"
+#include "serialization.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef limb_t ui;
+typedef double_limb_t ull;
+
+typedef data uint_array;
+
+big_integer_view::big_integer_view(big_integer const& a) :
+        sign(a.sign < 0),
+        digits(a.digits.begin()),
+        length(a.is_zero() ? 0 : a.digits.size())
+{}
+
+big_integer_view::big_integer_view(bool negative, ui const* limbs, size_t size) : digits(limbs), length(size) {
+    while (length > 0 && digits[length - 1] == 0) {
+        --length;
+    }
+    sign = negative && length > 0;
+}
+
+bool big_integer_view::negative() const {
+    return sign;
+}
+
+ui const* big_integer_view::limbs() const {
+    return digits;
+}
+
+size_t big_integer_view::size() const {
+    return length;
+}
+
+big_integer big_integer_view::to_big_integer() const {
+    uint_array copy(std::max(length, size_t(1)), 0);
+    std::copy(digits, digits + length, copy.begin());
+    return big_integer(sign ? -1 : 1, copy);
+}
+
+big_integer_view big_integer_view::operator-() const {
+    return big_integer_view(!sign, digits, length);
+}
+
+static int compare_magnitudes(big_integer_view a, big_integer_view b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i--;) {
+        if (a.limbs()[i] != b.limbs()[i]) {
+            return a.limbs()[i] < b.limbs()[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static int compare(big_integer_view a, big_integer_view b) {
+    if (a.negative() != b.negative()) {
+        return a.negative() ? -1 : 1;
+    }
+    int c = compare_magnitudes(a, b);
+    return a.negative() ? -c : c;
+}
+
+bool operator==(big_integer_view a, big_integer_view b) {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_integer_view a, big_integer_view b) {
+    return compare(a, b) < 0;
+}
+
+bool operator>(big_integer_view a, big_integer_view b) {
+    return compare(a, b) > 0;
+}
+
+bool operator<=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) <= 0;
+}
+
+bool operator>=(big_integer_view a, big_integer_view b) {
+    return compare(a, b) >= 0;
+}
+
+// |a| + |b| with the sign of a.
+static big_integer add_magnitudes(big_integer_view a, big_integer_view b) {
+    if (a.size() < b.size()) {
+        std::swap(a, b);
+    }
+    size_t n = a.size(), m = b.size();
+    uint_array r(n + 1, 0);
+    ui* d = r.begin();
+    ull carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        carry += (ull) a.limbs()[i] + (i < m ? b.limbs()[i] : 0);
+        d[i] = (ui) carry;
+        carry >>= LIMB_BITS;
+    }
+    d[n] = (ui) carry;
+    return big_integer(a.negative() ? -1 : 1, r);
+}
+
+// |a| - |b| with the sign of a, for |a| >= |b|.
+static big_integer sub_magnitudes(big_integer_view a, big_integer_view b) {
+    size_t n = a.size(), m = b.size();
+    uint_array r(std::max(n, size_t(1)), 0);
+    ui* d = r.begin();
+    ui borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        ull x = a.limbs()[i], y = (ull) (i < m ? b.limbs()[i] : 0) + borrow;
+        d[i] = (ui) (x - y);
+        borrow = x < y;
+    }
+    return big_integer(a.negative() ? -1 : 1, r);
+}
+
+big_integer operator+(big_integer_view a, big_integer_view b) {
+    if (a.negative() == b.negative()) {
+        return add_magnitudes(a, b);
+    }
+    return compare_magnitudes(a, b) >= 0 ? sub_magnitudes(a, b) : sub_magnitudes(b, a);
+}
+
+big_integer operator-(big_integer_view a, big_integer_view b) {
+    return a + -b;
+}
+
+big_integer operator*(big_integer_view a, big_integer_view b) {
+    if (a.size() == 0 || b.size() == 0) {
+        return big_integer();
+    }
+    uint_array r(a.size() + b.size(), 0);
+    multiply(r.begin(), a.limbs(), a.size(), b.limbs(), b.size());
+    return big_integer(a.negative() != b.negative() ? -1 : 1, r);
+}
+
+static char const TABLE_MAGIC[8] = {'B', 'I', 'G', 'T', 'A', 'B', 'L', 'E'};
+static uint64_t const TABLE_VERSION = 1;
+static size_t const TABLE_HEADER_BYTES = 24;
+static size_t const TABLE_ENTRY_BYTES = 16;
+
+static uint64_t read_le(unsigned char const* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i--;) {
+        value = value << 8u | p[i];
+    }
+    return value;
+}
+
+static void write_le(unsigned char* p, size_t bytes, uint64_t value) {
+    for (size_t i = 0; i < bytes; ++i, value >>= 8u) {
+        p[i] = (unsigned char) value;
+    }
+}
+
+static uint64_t align(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+big_integer_table::big_integer_table(std::string const& path) : base(nullptr), bytes(0), count(0) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+    bytes = (size_t) info.st_size;
+    if (bytes < TABLE_HEADER_BYTES) {
+        ::close(fd);
+        throw std::runtime_error(path + ": not a big_integer_table");
+    }
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), path);
+    }
+    base = static_cast<unsigned char const*>(mapping);
+
+    char const* problem = nullptr;
+    if (std::memcmp(base, TABLE_MAGIC, sizeof TABLE_MAGIC) != 0) {
+        problem = ": not a big_integer_table";
+    } else if (read_le(base + 8, 4) != TABLE_VERSION) {
+        problem = ": unsupported big_integer_table version";
+    } else if (read_le(base + 12, 4) != sizeof(ui) || !little_endian_host()) {
+        problem = ": big_integer_table limbs do not match this build";
+    } else if (read_le(base + 16, 8) > (bytes - TABLE_HEADER_BYTES) / TABLE_ENTRY_BYTES) {
+        problem = ": big_integer_table index is truncated";
+    }
+    if (problem) {
+        ::munmap(mapping, bytes);
+        throw std::runtime_error(path + problem);
+    }
+    count = (size_t) read_le(base + 16, 8);
+}
+
+big_integer_table::big_integer_table(big_integer_table&& other) noexcept :
+        base(other.base),
+        bytes(other.bytes),
+        count(other.count)
+{
+    other.base = nullptr;
+    other.bytes = other.count = 0;
+}
+
+big_integer_table& big_integer_table::operator=(big_integer_table&& other) noexcept {
+    std::swap(base, other.base);
+    std::swap(bytes, other.bytes);
+    std::swap(count, other.count);
+    return *this;
+}
+
+big_integer_table::~big_integer_table() {
+    if (base) {
+        ::munmap(const_cast<unsigned char*>(base), bytes);
+    }
+}
+
+size_t big_integer_table::size() const {
+    return count;
+}
+
+big_integer_view big_integer_table::operator[](size_t i) const {
+    assert(i < count);
+    unsigned char const* entry = base + TABLE_HEADER_BYTES + TABLE_ENTRY_BYTES * i;
+    uint64_t offset = read_le(entry, 8), limbs = read_le(entry + 8, 8) >> 1u;
+    if (offset % alignof(ui) != 0 || offset > bytes || limbs > (bytes - offset) / sizeof(ui)) {
+        throw std::runtime_error("big_integer_table: entry outside the file");
+    }
+    return big_integer_view((entry[8] & 1u) != 0, reinterpret_cast<ui const*>(base + offset), (size_t) limbs);
+}
+
+void big_integer_table::write(std::string const& path, std::vector<big_integer> const& values) {
+    std::vector<unsigned char> head(align(TABLE_HEADER_BYTES + TABLE_ENTRY_BYTES * values.size()), 0);
+    std::memcpy(head.data(), TABLE_MAGIC, sizeof TABLE_MAGIC);
+    write_le(&head[8], 4, TABLE_VERSION);
+    write_le(&head[12], 4, sizeof(ui));
+    write_le(&head[16], 8, values.size());
+    uint64_t offset = head.size();
+    for (size_t i = 0; i < values.size(); ++i) {
+        uint64_t limbs = export_words(values[i], sizeof(ui));
+        unsigned char* entry = &head[TABLE_HEADER_BYTES + TABLE_ENTRY_BYTES * i];
+        write_le(entry, 8, offset);
+        write_le(entry + 8, 8, 2 * limbs + (big_integer_view(values[i]).negative() ? 1 : 0));
+        offset += align(limbs * sizeof(ui));
+    }
+
+    std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<char const*>(head.data()), (std::streamsize) head.size());
+    std::vector<unsigned char> payload;
+    for (big_integer const& a : values) {
+        payload.assign(align(export_words(a, sizeof(ui)) * sizeof(ui)), 0);
+        export_bytes(payload.data(), a, sizeof(ui), endian::little, endian::little);
+        out.write(reinterpret_cast<char const*>(payload.data()), (std::streamsize) payload.size());
+    }
+    out.close();
+    if (!out) {
+        throw std::runtime_error(path + ": cannot write big_integer_table");
+    }
+}
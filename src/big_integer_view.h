@@ -0,0 +1,77 @@
+#ifndef BIGINT_BIG_INTEGER_VIEW_H
+#define BIGINT_BIG_INTEGER_VIEW_H
+
+#include "big_integer.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A read-only sign and little-endian limb array that it does not own: the
+// limbs of a big_integer, which must outlive the view and stay unchanged, or
+// of a big_integer_table entry. Compares and takes part in +, - and * without
+// copying the limbs; to_big_integer() makes an owning copy for the rest.
+class big_integer_view {
+public:
+    big_integer_view(big_integer const& a);
+    // Leading zero limbs are ignored; zero may have no limbs at all.
+    big_integer_view(bool negative, limb_t const* limbs, size_t size);
+
+    bool negative() const;
+    limb_t const* limbs() const;
+    // The limb count without leading zeros: 0 for zero.
+    size_t size() const;
+
+    big_integer to_big_integer() const;
+    big_integer_view operator-() const;
+
+private:
+    bool sign;
+    limb_t const* digits;
+    size_t length;
+};
+
+bool operator==(big_integer_view, big_integer_view);
+bool operator!=(big_integer_view, big_integer_view);
+bool operator<(big_integer_view, big_integer_view);
+bool operator>(big_integer_view, big_integer_view);
+bool operator<=(big_integer_view, big_integer_view);
+bool operator>=(big_integer_view, big_integer_view);
+
+big_integer operator+(big_integer_view, big_integer_view);
+big_integer operator-(big_integer_view, big_integer_view);
+big_integer operator*(big_integer_view, big_integer_view);
+
+// A read-only file of big integers mapped into memory, so opening it costs
+// the same for any number of entries and each value is paged in on first
+// use. The layout is little-endian throughout:
+//   header  "BIGTABLE", u32 version, u32 limb bytes, u64 entry count;
+//   index   per entry a u64 file offset of its limbs and a u64 limb count
+//           times two, plus one when negative;
+//   payload the limbs of every entry, each run aligned to 8 bytes.
+// Opening throws std::system_error when the file cannot be mapped and
+// std::runtime_error when it is not a table this build can read.
+class big_integer_table {
+public:
+    explicit big_integer_table(std::string const& path);
+    big_integer_table(big_integer_table&& other) noexcept;
+    big_integer_table& operator=(big_integer_table&& other) noexcept;
+    big_integer_table(big_integer_table const&) = delete;
+    big_integer_table& operator=(big_integer_table const&) = delete;
+    ~big_integer_table();
+
+    size_t size() const;
+    // Valid while the table is open; throws std::runtime_error when the
+    // entry points outside the file.
+    big_integer_view operator[](size_t i) const;
+
+    // Writes values to path in the layout above; throws std::runtime_error
+    // on failure.
+    static void write(std::string const& path, std::vector<big_integer> const& values);
+
+private:
+    unsigned char const* base;
+    size_t bytes;
+    size_t count;
+};
+
+#endif //BIGINT_BIG_INTEGER_VIEW_H
@@ -0,0 +1,104 @@
+#include "conversion.h"
+#include <cassert>
+
+size_t radix_chunk_digits(unsigned int radix) {
+    assert(radix >= 2);
+    size_t count = 0;
+    for (double_limb_t power = radix; power < ((double_limb_t) 1 << LIMB_BITS); power *= radix) {
+        ++count;
+    }
+    return count;
+}
+
+radix_power_cache& radix_power_cache::instance() {
+    static radix_power_cache cache;
+    return cache;
+}
+
+// A plain reference count must not be touched from two threads, so without
+// the atomic one every caller gets limbs of its own instead of sharing the
+// cached ones.
+big_integer radix_power_cache::hand_out(big_integer const& cached) {
+#if BIGINT_ATOMIC_REFCOUNT
+    return cached;
+#else
+    return big_integer(cached.sign, cached.digits.clone());
+#endif
+}
+
+big_integer radix_power_cache::power(unsigned int radix, size_t k) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hand_out(grow(radix, k));
+}
+
+std::vector<big_integer> radix_power_cache::powers(unsigned int radix, size_t k) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<big_integer> result;
+    for (size_t i = 0; i < k; ++i) {
+        result.push_back(hand_out(grow(radix, i)));
+    }
+    return result;
+}
+
+void radix_power_cache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.clear();
+    limbs = 0;
+}
+
+size_t radix_power_cache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limbs;
+}
+
+size_t radix_power_cache::limit() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return max_limbs;
+}
+
+void radix_power_cache::set_limit(size_t new_limit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    max_limbs = new_limit;
+    // Drop the largest powers first, so every list stays a prefix of its powers.
+    while (limbs > max_limbs) {
+        std::vector<big_integer>* longest = nullptr;
+        for (auto& entry : cache) {
+            if (longest == nullptr || entry.second.size() > longest->size()) {
+                longest = &entry.second;
+            }
+        }
+        longest->pop_back();
+        limbs -= size_t(1) << longest->size();
+    }
+}
+
+// Squares up from the largest cached power. (radix^c)^(2^k) is below
+// 2^(LIMB_BITS * 2^k), c = radix_chunk_digits(radix), so 2^k limbs are
+// charged against the limit for it.
+big_integer radix_power_cache::grow(unsigned int radix, size_t k) {
+    std::vector<big_integer>& list = cache[radix];
+    if (k < list.size()) {
+        return list[k];
+    }
+    big_integer result;
+    if (list.empty()) {
+        result = 1;
+        for (size_t i = radix_chunk_digits(radix); i--;) {
+            result *= (int) radix;
+        }
+    } else {
+        result = list.back();
+    }
+    for (size_t i = list.empty() ? 0 : list.size() - 1; i < k; ++i) {
+        if (list.size() == i && limbs + (size_t(1) << i) <= max_limbs) {
+            list.push_back(result);
+            limbs += size_t(1) << i;
+        }
+        result = square(result);
+    }
+    if (list.size() == k && limbs + (size_t(1) << k) <= max_limbs) {
+        list.push_back(result);
+        limbs += size_t(1) << k;
+    }
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef BIGINT_CONVERSION_H
+#define BIGINT_CONVERSION_H
+
+#include "big_integer.h"
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// With c = radix_chunk_digits(10), the digits of one limb: limb count below
+// which to_string() peels c decimal digits per pass of div(10^c) instead of
+// splitting the value by a power 10^(c * 2^k).
+size_t static const TO_STRING_THRESHOLD = 10;
+
+// Count of c-digit chunks below which the string constructor accumulates by
+// mul(10^c) and add() instead of combining halves as high * 10^(c * 2^k) + low.
+size_t static const FROM_STRING_THRESHOLD = 40;
+
+// Default limit, in limbs, on what radix_power_cache keeps: 64 MiB.
+size_t static const RADIX_POWER_CACHE_LIMBS = (size_t(1) << 26u) / sizeof(limb_t);
+
+// The number of digits in radix that fit in a limb together: the largest c
+// with radix^c < 2^LIMB_BITS, 9 for decimal with 32-bit limbs and 19 with
+// 64-bit ones.
+size_t radix_chunk_digits(unsigned int radix);
+
+// The powers (radix^c)^(2^k), c = radix_chunk_digits(radix), that the
+// divide-and-conquer conversions split and combine by. Shared by every
+// conversion and thread: it grows lazily under a mutex and hands out copies
+// that share the cached limbs, or own copies of them when
+// BIGINT_ATOMIC_REFCOUNT is 0. Powers that would take it past limit() limbs
+// are computed for the caller but not kept, and lowering the limit drops the
+// largest cached powers until it fits.
+class radix_power_cache {
+public:
+    static radix_power_cache& instance();
+
+    big_integer power(unsigned int radix, size_t k);
+    // power(radix, 0), ..., power(radix, k - 1).
+    std::vector<big_integer> powers(unsigned int radix, size_t k);
+
+    void clear();
+    size_t size() const;
+    size_t limit() const;
+    void set_limit(size_t new_limit);
+
+private:
+    radix_power_cache() = default;
+
+    mutable std::mutex mutex;
+    std::map<unsigned int, std::vector<big_integer>> cache;
+    size_t limbs = 0;
+    size_t max_limbs = RADIX_POWER_CACHE_LIMBS;
+
+    big_integer grow(unsigned int radix, size_t k);
+    static big_integer hand_out(big_integer const& cached);
+};
+
+#endif //BIGINT_CONVERSION_H
@@ -3,19 +3,26 @@
 //
 
 #include "data.h"
+#include <algorithm>
 #include <cstring>
 #include <cassert>
+#include <new>
+
+#if BIGINT_ATOMIC_REFCOUNT && defined(__has_include)
+#if __has_include(<sys/single_threaded.h>)
+#include <sys/single_threaded.h>
+#define BIGINT_HAS_SINGLE_THREADED
+#endif
+#endif
 
 //data::data() : _size(0), is_array(true) {}
 
 data::data(size_t n) : data(n, 0) {}
 
-data::data(size_t n, unsigned int value) : _size(n) {
+data::data(size_t n, limb_t value) : _size(n) {
     if (n > DEFAULT_SIZE) {
-        size_t capacity = make_capacity(_size);
-        auto tmp = new unsigned int[capacity];
-        new (&_data.vec) vector(capacity, std::shared_ptr<unsigned int>(tmp, std::default_delete<unsigned int[]>()));
-        std::fill(_data.vec.ptr.get(), _data.vec.ptr.get() + _size, value);
+        _data.vec = allocate(make_capacity(_size));
+        std::fill(_data.vec->limbs(), _data.vec->limbs() + _size, value);
         is_array = false;
     } else {
         std::fill(_data.arr, _data.arr + _size, value);
@@ -25,15 +32,20 @@ data::data(size_t n, unsigned int value) : _size(n) {
 
 data::data(data const& other) : _size(other._size), is_array(other.is_array) {
     if (is_array) {
-        memcpy(_data.arr, other._data.arr, _size * sizeof(unsigned int));
+        memcpy(_data.arr, other._data.arr, _size * sizeof(limb_t));
     } else {
-        new (&_data.vec) vector(other._data.vec);
+        _data.vec = other._data.vec;
+        _data.vec->acquire();
     }
 }
 
+data::data(data&& other) noexcept : _size(0), is_array(true) {
+    swap(other);
+}
+
 data::~data() {
     if (!is_array) {
-        _data.vec.~vector();
+        release(_data.vec);
     }
 }
 
@@ -42,94 +54,50 @@ data& data::operator=(data other) {
     return *this;
 }
 
-void data::assign(size_t n, unsigned int value) {
+void data::assign(size_t n, limb_t value) {
     *this = data(n, value);
 }
 
 
-unsigned int* data::begin() {
-    make_unique();
-    return get_data();
-}
-
-unsigned int const* data::begin() const {
-    return get_data();
-}
-
-unsigned int* data::end() {
-    make_unique();
-    return get_data() + _size;
-}
-
-
-unsigned int const* data::end() const {
-    return get_data() + _size;
-}
-
-unsigned int& data::back() {
-    make_unique();
-    return *(get_data() + _size - 1);
-}
-
-
-unsigned int const& data::back() const {
-    return *(get_data() + _size - 1);
-}
-
-void data::push_back(unsigned int value) {
-    make_unique();
-    if (is_array && _size == DEFAULT_SIZE) {
-        size_t capacity = make_capacity(DEFAULT_SIZE + 1);
-        auto* tmp = new unsigned int[capacity];
-        memcpy(tmp, _data.arr, DEFAULT_SIZE * sizeof(unsigned int));
-        new (&_data.vec) vector(capacity, std::shared_ptr<unsigned int>(tmp, std::default_delete<unsigned int[]>()));
-        is_array = false;
-    }
-    if (!is_array && _size == _data.vec._capacity) {
-        size_t capacity = make_capacity(_size + 1);
-        auto* tmp = new unsigned int[capacity];
-        memcpy(tmp, _data.vec.ptr.get(), _size * sizeof(unsigned int));
-        _data.vec.ptr.reset(tmp, std::default_delete<unsigned int[]>());
-        _data.vec._capacity = capacity;
+void data::push_back(limb_t value) {
+    if (_size == capacity()) {
+        reallocate(make_capacity(_size + 1));
+    } else {
+        make_unique();
     }
-    (*this)[_size++] = value;
+    get_data()[_size++] = value;
 }
 
 
 void data::pop_back() {
     assert(_size > 0);
-    make_unique();
+    // Only the length is this object's own; a shared buffer stays untouched.
     --_size;
 }
 
-unsigned int& data::operator[](size_t pos) {
-    assert(0 <= pos && pos < _size);
-    make_unique();
-    return *(get_data() + pos);
-}
-
-
-unsigned int const& data::operator[](size_t pos) const {
-    assert(0 <= pos && pos < _size);
-    return *(get_data() + pos);
-}
-
-size_t data::size() const {
-    return _size;
+size_t data::capacity() const {
+    return is_array ? DEFAULT_SIZE : _data.vec->capacity;
 }
 
-bool data::empty() const {
-    return _size == 0;
+void data::reserve(size_t n) {
+    if (n > capacity()) {
+        reallocate(std::max(n, DEFAULT_CAPACITY));
+    } else {
+        make_unique();
+    }
 }
 
 void data::swap(data& other) {
     std::swap(_size, other._size);
     std::swap(is_array, other.is_array);
 
-    char copy[sizeof(united)];
-    memcpy(copy, &_data, sizeof(united));
-    memcpy(&_data, &other._data, sizeof(united));
-    memcpy(&other._data, copy, sizeof(united));
+    std::swap(_data, other._data);
+}
+
+data data::clone() const {
+    data copy(_size);
+    memcpy(copy.begin(), get_data(), _size * sizeof(limb_t));
+    return copy;
 }
 
 bool operator==(data const& a, data const& b) {
@@ -153,15 +121,71 @@ size_t data::make_capacity(size_t n) {
     }
 }
 
-unsigned int* data::get_data() const {
-    return is_array ? const_cast<unsigned int*>(_data.arr) : _data.vec.ptr.get();
+#if BIGINT_ATOMIC_REFCOUNT
+
+// Like libstdc++'s shared_ptr, skip the locked instructions while the
+// process has a single thread; glibc clears the flag for good on the first
+// pthread_create.
+static bool single_threaded() {
+#ifdef BIGINT_HAS_SINGLE_THREADED
+    return __libc_single_threaded != 0;
+#else
+    return false;
+#endif
+}
+
+void data::block::acquire() {
+    if (single_threaded()) {
+        refs.store(refs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    } else {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool data::block::drop() {
+    if (single_threaded()) {
+        size_t left = refs.load(std::memory_order_relaxed) - 1;
+        refs.store(left, std::memory_order_relaxed);
+        return left == 0;
+    }
+    // The last owner must see every write the others made before letting go.
+    return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
 }
 
-void data::make_unique() {
-    if (is_array || _data.vec.ptr.unique()) {
-        return;
+#else
+
+void data::block::acquire() {
+    ++refs;
+}
+
+bool data::block::drop() {
+    return --refs == 0;
+}
+
+#endif
+
+data::block* data::allocate(size_t capacity) {
+    void* memory = ::operator new(sizeof(block) + capacity * sizeof(limb_t));
+    block* b = new (memory) block;
+    b->refs = 1;
+    b->capacity = capacity;
+    return b;
+}
+
+void data::release(block* b) {
+    if (b->drop()) {
+        b->~block();
+        ::operator delete(b);
+    }
+}
+
+void data::reallocate(size_t capacity) {
+    assert(capacity >= _size);
+    block* tmp = allocate(capacity);
+    memcpy(tmp->limbs(), get_data(), _size * sizeof(limb_t));
+    if (!is_array) {
+        release(_data.vec);
     }
-    auto tmp = new unsigned int[_data.vec._capacity];
-    memcpy(tmp, _data.vec.ptr.get(), _data.vec._capacity * sizeof(unsigned int));
-    _data.vec.ptr.reset(tmp, std::default_delete<unsigned int[]>());
+    _data.vec = tmp;
+    is_array = false;
 }
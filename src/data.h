@@ -5,11 +5,87 @@
 #ifndef BIGINT_DATA_H
 #define BIGINT_DATA_H
 
-#include <memory>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
 #include <utility>
 
+// The limb type: BIGINT_LIMB_BITS picks 32 or 64 bits. 64 is the default on
+// x86-64 and AArch64, where unsigned __int128 gives the double-width products
+// that every kernel is written in; elsewhere limbs are 32 bits wide and
+// products unsigned long long.
+#ifndef BIGINT_LIMB_BITS
+#if defined(__SIZEOF_INT128__) && (defined(__x86_64__) || defined(__aarch64__))
+#define BIGINT_LIMB_BITS 64
+#else
+#define BIGINT_LIMB_BITS 32
+#endif
+#endif
+
+#if BIGINT_LIMB_BITS == 64
+typedef unsigned long long limb_t;
+__extension__ typedef unsigned __int128 double_limb_t;
+#elif BIGINT_LIMB_BITS == 32
+typedef unsigned int limb_t;
+typedef unsigned long long double_limb_t;
+#else
+#error "BIGINT_LIMB_BITS must be 32 or 64"
+#endif
+
+unsigned static const LIMB_BITS = BIGINT_LIMB_BITS;
+
+// How copies of a heap buffer count their owners. 1, the default, uses an
+// atomic count so that values may be copied on several threads at once, as
+// the shared radix power cache does. 0 uses a plain count and saves the
+// atomic operations; then a value and all of its copies must stay on one
+// thread at a time, and the radix power cache hands out deep copies so that
+// conversions still run on several threads.
+#ifndef BIGINT_ATOMIC_REFCOUNT
+#define BIGINT_ATOMIC_REFCOUNT 1
+#endif
+
+#if BIGINT_ATOMIC_REFCOUNT
+typedef std::atomic<size_t> refcount_t;
+#else
+typedef size_t refcount_t;
+#endif
+
+// Writable limbs for an inner loop: a raw pointer and a length, indexed
+// without the shared-buffer check of data::operator[]. Valid until its data
+// is resized, copied or destroyed.
+struct limb_span {
+    limb_t* ptr;
+    size_t length;
+
+    limb_t* begin() const {
+        return ptr;
+    }
+
+    limb_t* end() const {
+        return ptr + length;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    limb_t& operator[](size_t pos) const {
+        assert(pos < length);
+        return ptr[pos];
+    }
+};
+
+// How many limbs a data keeps inline before it allocates. The default of
+// four keeps sizeof(data) at two words plus four limbs with either limb
+// width; raise it when most values are a little larger.
+#ifndef BIGINT_INLINE_LIMBS
+#define BIGINT_INLINE_LIMBS 4
+#endif
+
+static_assert(BIGINT_INLINE_LIMBS > 0, "BIGINT_INLINE_LIMBS must be positive");
+
 size_t static const DEFAULT_CAPACITY = 10;
-size_t static const DEFAULT_SIZE = 4;
+size_t static const DEFAULT_SIZE = BIGINT_INLINE_LIMBS;
 
 class data {
 public:
@@ -18,79 +94,172 @@ public:
 
     explicit data(size_t n);
 
-    data(size_t n, unsigned int value);
+    data(size_t n, limb_t value);
 
     data(data const& other);
 
-    data(data&& other) = default;
+    data(data&& other) noexcept;
 
     data& operator=(data other);
 
     ~data();
 
 
-    unsigned int* begin();
+    limb_t* begin();
 
-    unsigned int const* begin() const;
+    limb_t const* begin() const;
 
-    unsigned int* end();
+    limb_t* end();
 
-    unsigned int const* end() const;
+    limb_t const* end() const;
 
 
-    void push_back(unsigned int value);
+    void push_back(limb_t value);
 
     void pop_back();
 
-    unsigned int& back();
+    limb_t& back();
 
-    unsigned int const& back() const;
+    limb_t const& back() const;
 
+    // All limbs for writing; unshares once, here, instead of on each access.
+    limb_span span();
 
-    unsigned int& operator[](size_t pos);
 
-    unsigned int const& operator[](size_t pos) const;
+    limb_t& operator[](size_t pos);
+
+    limb_t const& operator[](size_t pos) const;
 
 
     bool empty() const;
 
     size_t size() const;
 
-    void assign(size_t n, unsigned int value);
+    // The limbs that fit before push_back() has to allocate.
+    size_t capacity() const;
+
+    // Leaves a buffer of this object's own with room for at least n limbs,
+    // unsharing and growing in one allocation that copies only the live limbs.
+    void reserve(size_t n);
+
+    void assign(size_t n, limb_t value);
 
     void swap(data& other);
 
+    // A copy in a buffer of its own, made without touching this object's
+    // reference count.
+    data clone() const;
+
     friend bool operator==(data const& a, data const& b);
 
 private:
     size_t _size = 0;
     bool is_array = true;
 
-    struct vector {
-        size_t _capacity = DEFAULT_CAPACITY;
-        std::shared_ptr<unsigned int> ptr = nullptr;
+    // One allocation: this header, then capacity limbs.
+    struct block {
+        refcount_t refs;
+        size_t capacity;
 
-        vector() = default;
-        vector(size_t capacity, std::shared_ptr<unsigned int> pointer) :
-                _capacity(capacity),
-                ptr(std::move(pointer))
-        {}
+        limb_t* limbs() {
+            return reinterpret_cast<limb_t*>(this + 1);
+        }
+
+        void acquire();
+
+        bool unique() const {
+#if BIGINT_ATOMIC_REFCOUNT
+            return refs.load(std::memory_order_acquire) == 1;
+#else
+            return refs == 1;
+#endif
+        }
+
+        // Whether this was the last owner.
+        bool drop();
     };
 
     union united {
-        unsigned int arr[DEFAULT_SIZE];
-        vector vec;
-
-        united() {}
-        ~united() {}
+        limb_t arr[DEFAULT_SIZE];
+        block* vec;
     } _data;
 
     size_t make_capacity(size_t n);
 
-    unsigned int* get_data() const;
+    static block* allocate(size_t capacity);
+
+    static void release(block* b);
+
+    // Moves the live limbs to a new heap buffer of the given capacity.
+    void reallocate(size_t capacity);
+
+    limb_t* get_data() const;
 
     void make_unique();
 };
 
+#if BIGINT_INLINE_LIMBS == 4
+static_assert(sizeof(data) == 2 * sizeof(size_t) + 4 * sizeof(limb_t), "data changed size");
+#endif
+
+// The element accessors run inside every arithmetic loop, so they and the
+// check for a shared buffer are inline; only the copy itself is not.
+
+inline limb_t* data::get_data() const {
+    return is_array ? const_cast<limb_t*>(_data.arr) : _data.vec->limbs();
+}
+
+inline void data::make_unique() {
+    if (!is_array && !_data.vec->unique()) {
+        reallocate(_data.vec->capacity);
+    }
+}
+
+inline limb_t* data::begin() {
+    make_unique();
+    return get_data();
+}
+
+inline limb_t const* data::begin() const {
+    return get_data();
+}
+
+inline limb_t* data::end() {
+    return begin() + _size;
+}
+
+inline limb_t const* data::end() const {
+    return get_data() + _size;
+}
+
+inline limb_t& data::back() {
+    return begin()[_size - 1];
+}
+
+inline limb_t const& data::back() const {
+    return get_data()[_size - 1];
+}
+
+inline limb_span data::span() {
+    return {begin(), _size};
+}
+
+inline limb_t& data::operator[](size_t pos) {
+    assert(pos < _size);
+    return begin()[pos];
+}
+
+inline limb_t const& data::operator[](size_t pos) const {
+    assert(pos < _size);
+    return get_data()[pos];
+}
+
+inline size_t data::size() const {
+    return _size;
+}
+
+inline bool data::empty() const {
+    return _size == 0;
+}
 
 #endif //BIGINT_DATA_H
@@ -0,0 +1,134 @@
+#include "division.h"
+#include "data.h"
+#include <algorithm>
+#include <cassert>
+
+typedef limb_t ui;
+typedef double_limb_t ull;
+
+static int leading_zeros(ui x) {
+    int count = 0;
+    for (ui bit = (ui) 1 << (LIMB_BITS - 1); (x & bit) == 0; bit >>= 1u) {
+        ++count;
+    }
+    return count;
+}
+
+// dst[0..n) = src[0..n) << shift, returning the bits shifted out; shift < LIMB_BITS.
+static ui shift_left(ui* dst, ui const* src, size_t n, int shift) {
+    if (shift == 0) {
+        std::copy(src, src + n, dst);
+        return 0;
+    }
+    ui out = src[n - 1] >> (LIMB_BITS - shift);
+    for (size_t i = n - 1; i > 0; --i) {
+        dst[i] = (src[i] << (ui) shift) | (src[i - 1] >> (LIMB_BITS - shift));
+    }
+    dst[0] = src[0] << (ui) shift;
+    return out;
+}
+
+// Moller and Granlund, "Improved division by invariant integers", 2011:
+// divides u1 * B + u0 by d with two multiplications instead of a division.
+static ui div_word(ui& q, ui u1, ui u0, ui d, ui inverse) {
+    ull estimate = (ull) inverse * u1 + (((ull) u1 + 1) << LIMB_BITS) + u0;
+    auto quotient = (ui) (estimate >> LIMB_BITS);
+    ui rest = u0 - quotient * d;
+    if (rest > (ui) estimate) {
+        --quotient;
+        rest += d;
+    }
+    if (rest >= d) {
+        ++quotient;
+        rest -= d;
+    }
+    q = quotient;
+    return rest;
+}
+
+void div_schoolbook(ui* q, ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    assert(n >= m && m >= 2 && b[m - 1] != 0);
+    // Scale both operands so that the top bit of the divisor is set; the
+    // quotient digit estimate is then off by at most two.
+    int shift = leading_zeros(b[m - 1]);
+    data scaled_b(m);
+    ui* v = scaled_b.begin();
+    shift_left(v, b, m, shift);
+    div_schoolbook_scaled(q, r, a, n, v, m, shift, reciprocal_word(v[m - 1]));
+}
+
+void div_schoolbook_scaled(ui* q, ui* r, ui const* a, size_t n, ui const* v, size_t m, int shift, ui inverse) {
+    assert(n >= m && m >= 2 && (v[m - 1] >> (LIMB_BITS - 1)) != 0);
+    ull const base = (ull) 1 << LIMB_BITS;
+
+    data scaled_a(n + 1);
+    ui* u = scaled_a.begin();
+    u[n] = shift_left(u, a, n, shift);
+
+    for (size_t j = n - m + 1; j--;) {
+        // The top two limbs over v[m - 1], then Knuth's correction by the
+        // next limb. u[j + m] never exceeds v[m - 1], and when they are equal
+        // the estimate is B - 1.
+        ull estimate, rest;
+        if (u[j + m] == v[m - 1]) {
+            estimate = base - 1;
+            rest = (ull) u[j + m - 1] + v[m - 1];
+        } else {
+            ui digit;
+            rest = div_word(digit, u[j + m], u[j + m - 1], v[m - 1], inverse);
+            estimate = digit;
+        }
+        while (rest < base && estimate * v[m - 2] > ((rest << LIMB_BITS) | u[j + m - 2])) {
+            --estimate;
+            rest += v[m - 1];
+        }
+
+        // u[j..j + m] -= estimate * v
+        ull propagate = 0;
+        for (size_t i = 0; i < m; ++i) {
+            ull product = estimate * v[i] + propagate;
+            auto low = (ui) product;
+            propagate = (product >> LIMB_BITS) + (u[i + j] < low);
+            u[i + j] -= low;
+        }
+        bool negative = u[j + m] < propagate;
+        u[j + m] = (ui) (u[j + m] - propagate);
+
+        if (negative) {
+            // The estimate was one too large: add v back.
+            --estimate;
+            propagate = 0;
+            for (size_t i = 0; i < m; ++i) {
+                propagate += (ull) u[i + j] + v[i];
+                u[i + j] = (ui) propagate;
+                propagate >>= LIMB_BITS;
+            }
+            u[j + m] = (ui) (u[j + m] + propagate);
+        }
+        q[j] = (ui) estimate;
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+        r[i] = shift == 0 ? u[i] : (u[i] >> (ui) shift) | (u[i + 1] << (LIMB_BITS - shift));
+    }
+}
+
+ui reciprocal_word(ui d) {
+    assert((d >> (LIMB_BITS - 1)) != 0);
+    // floor((B^2 - 1) / d) lies in [B, 2B); B itself is implied.
+    return (ui) (~(ull) 0 / d);
+}
+
+ui div_word_preinv(ui* q, ui const* a, size_t n, ui d, ui inverse, int shift) {
+    assert(n >= 1 && (d >> (LIMB_BITS - 1)) != 0);
+    // The dividend is scaled by 2^shift on the fly, one limb at a time.
+    ui rest = shift == 0 ? 0 : a[n - 1] >> (LIMB_BITS - shift);
+    for (size_t i = n; i--;) {
+        ui limb = a[i] << (ui) shift;
+        if (shift != 0 && i > 0) {
+            limb |= a[i - 1] >> (LIMB_BITS - shift);
+        }
+        rest = div_word(q[i], rest, limb, d, inverse);
+    }
+    return rest >> (ui) shift;
+}
@@ -0,0 +1,49 @@
+#ifndef BIGINT_DIVISION_H
+#define BIGINT_DIVISION_H
+
+#include "data.h"
+#include <cstddef>
+
+// Divisor limb count from which divmod() uses Burnikel-Ziegler recursive
+// division, provided the quotient is at least as long. Its sub-steps are
+// multiplications, so it inherits every multiplication tier; below the
+// threshold, and at the leaves of the recursion, div_schoolbook() runs.
+size_t static const BURNIKEL_ZIEGLER_THRESHOLD = 300;
+
+// Divisor limb count from which divmod() multiplies by a Newton reciprocal
+// instead, again provided the quotient is at least as long. reciprocal()
+// computes precisions below it by a direct division.
+size_t static const NEWTON_THRESHOLD = 8000;
+
+// Divisor limb count from which big_divisor reduces with a precomputed
+// Barrett reciprocal where divmod() would use a recursive method; it then
+// costs two multiplications per divisor-sized block of the dividend and
+// overtakes Burnikel-Ziegler a little above its threshold.
+size_t static const BARRETT_THRESHOLD = 400;
+
+static_assert(BURNIKEL_ZIEGLER_THRESHOLD <= BARRETT_THRESHOLD && BARRETT_THRESHOLD <= NEWTON_THRESHOLD,
+              "big_divisor picks Barrett from within the recursive division tiers");
+
+// Knuth's algorithm D on little-endian limb arrays: a[0..n) divided by
+// b[0..m), n >= m >= 2, b[m - 1] != 0. q receives n - m + 1 quotient limbs
+// and r the m remainder limbs; neither may overlap the inputs.
+void div_schoolbook(limb_t* q, limb_t* r, limb_t const* a, size_t n,
+                    limb_t const* b, size_t m);
+
+// div_schoolbook() for a divisor already scaled by 2^shift so that the top
+// bit of v[m - 1] is set, with inverse = reciprocal_word(v[m - 1]) for the
+// quotient estimates; a and the results are as there, unscaled.
+void div_schoolbook_scaled(limb_t* q, limb_t* r, limb_t const* a, size_t n,
+                           limb_t const* v, size_t m, int shift, limb_t inverse);
+
+// The Moller-Granlund reciprocal floor((B^2 - 1) / d) - B of a limb d with
+// its top bit set, B = 2^LIMB_BITS.
+limb_t reciprocal_word(limb_t d);
+
+// a[0..n) divided by a one-limb divisor given as d = divisor << shift with
+// the top bit set and its reciprocal_word(). q receives n limbs; returns the
+// remainder. Multiplies where a division instruction would be used.
+limb_t div_word_preinv(limb_t* q, limb_t const* a, size_t n, limb_t d,
+                       limb_t inverse, int shift);
+
+#endif //BIGINT_DIVISION_H
@@ -0,0 +1,184 @@
+#include "exponentiation.h"
+#include "big_divisor.h"
+#include "montgomery.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+typedef limb_t ui;
+
+typedef data uint_array;
+
+// Residues kept as plain values in [0, modulus) and reduced after every
+// product by a big_divisor, for the even moduli Montgomery form cannot
+// handle; that is schoolbook division below BARRETT_THRESHOLD limbs.
+class divisor_context {
+public:
+    explicit divisor_context(big_integer const& modulus) : divisor(modulus), unit(1) {}
+
+    big_integer const& one() const {
+        return unit;
+    }
+
+    big_integer mul(big_integer const& a, big_integer const& b) const {
+        return divisor.mod(a * b);
+    }
+
+    big_integer sqr(big_integer const& a) const {
+        return divisor.mod(square(a));
+    }
+
+private:
+    big_divisor divisor;
+    big_integer unit;
+};
+
+static bool bit(ui const* e, size_t i) {
+    return ((e[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1u) != 0;
+}
+
+static size_t window_size(size_t bits) {
+    size_t k = 1;
+    for (size_t limit : {8, 24, 80, 240, 672}) {
+        k += bits > limit;
+    }
+    return k;
+}
+
+// x^e for e given by n limbs. Windows of up to k bits end in a set bit, so
+// only the odd powers x, x^3, ..., x^(2^k - 1) are tabulated.
+template <class Context>
+static big_integer sliding_window_power(Context const& context, big_integer const& x, ui const* e, size_t n) {
+    size_t bits = LIMB_BITS * n;
+    while (bits > 0 && !bit(e, bits - 1)) {
+        --bits;
+    }
+    if (bits == 0) {
+        return context.one();
+    }
+    size_t k = window_size(bits);
+    std::vector<big_integer> odd_powers(size_t(1) << (k - 1), x);
+    big_integer x_squared = context.sqr(x);
+    for (size_t i = 1; i < odd_powers.size(); ++i) {
+        odd_powers[i] = context.mul(odd_powers[i - 1], x_squared);
+    }
+
+    big_integer result;
+    bool started = false;
+    for (size_t i = bits; i > 0;) {
+        if (!bit(e, i - 1)) {
+            result = context.sqr(result);
+            --i;
+            continue;
+        }
+        size_t low = i > k ? i - k : 0;
+        while (!bit(e, low)) {
+            ++low;
+        }
+        size_t window = 0;
+        for (size_t j = i; j-- > low;) {
+            window = 2 * window + bit(e, j);
+            if (started) {
+                result = context.sqr(result);
+            }
+        }
+        result = started ? context.mul(result, odd_powers[window / 2]) : odd_powers[window / 2];
+        started = true;
+        i = low;
+    }
+    return result;
+}
+
+big_integer powmod(big_integer const& base, big_integer const& exponent, big_integer const& modulus) {
+    assert(exponent.sign > 0 && modulus.sign > 0 && !modulus.is_zero());
+    if (modulus == 1) {
+        return big_integer(0);
+    }
+    ui const* e = exponent.digits.begin();
+    size_t n = exponent.digits.size();
+    if ((modulus.digits[0] & 1u) != 0) {
+        montgomery_context context(modulus);
+        return context.from_montgomery(sliding_window_power(context, context.to_montgomery(base), e, n));
+    }
+    big_integer reduced = base % modulus;
+    if (reduced.sign < 0) {
+        reduced += modulus;
+    }
+    return sliding_window_power(divisor_context(modulus), reduced, e, n);
+}
+
+// chosen[0..n) = table entry window of 16 entries of n limbs each, copied
+// through a mask over every limb of every entry rather than indexed.
+static void select(ui* chosen, ui const* table, ui window, size_t n) {
+    std::fill(chosen, chosen + n, 0);
+    for (ui i = 0; i < 16; ++i) {
+        ui mask = 0u - (ui) (i == window);
+        for (size_t j = 0; j < n; ++j) {
+            chosen[j] |= table[i * n + j] & mask;
+        }
+    }
+}
+
+// result = x^e with 4-bit windows taken from the top of all LIMB_BITS * en
+// bits of e. Residues are n limbs wide throughout and mul(r, a, b) multiplies
+// them, r possibly aliasing a or b; one and x are in the form mul expects.
+template <class Mul>
+static void fixed_window_power(Mul const& mul, ui* result, ui const* one, ui const* x, size_t n,
+                               ui const* e, size_t en) {
+    uint_array table(16 * n), chosen(n);
+    std::copy(one, one + n, table.begin());
+    for (size_t i = 1; i < 16; ++i) {
+        mul(table.begin() + i * n, table.begin() + (i - 1) * n, x);
+    }
+    std::copy(one, one + n, result);
+    for (size_t i = LIMB_BITS * en; i > 0; i -= 4) {
+        for (int j = 0; j < 4; ++j) {
+            mul(result, result, result);
+        }
+        select(chosen.begin(), table.begin(), (e[(i - 4) / LIMB_BITS] >> ((i - 4) % LIMB_BITS)) & 15u, n);
+        mul(result, result, chosen.begin());
+    }
+}
+
+big_integer powmod_constant_time(big_integer const& base, big_integer const& exponent,
+                                 big_integer const& modulus) {
+    assert(exponent.sign > 0 && modulus.sign > 0 && !modulus.is_zero());
+    if (modulus == 1) {
+        return big_integer(0);
+    }
+    size_t n = modulus.digits.size();
+    // Values in [0, modulus) widened to exactly n limbs, and back.
+    auto widen = [n](big_integer const& a) {
+        uint_array wide(n, 0);
+        std::copy(a.digits.begin(), a.digits.end(), wide.begin());
+        return wide;
+    };
+    auto narrow = [n](ui const* a) {
+        uint_array limbs(n);
+        std::copy(a, a + n, limbs.begin());
+        return big_integer(1, limbs);
+    };
+    uint_array result(n);
+    ui const* e = exponent.digits.begin();
+    size_t en = exponent.digits.size();
+    if ((modulus.digits[0] & 1u) != 0) {
+        montgomery_context context(modulus);
+        auto mul = [&context](ui* r, ui const* a, ui const* b) {
+            context.mul_fixed(r, a, b);
+        };
+        fixed_window_power(mul, result.begin(), widen(context.one()).begin(),
+                           widen(context.to_montgomery(base)).begin(), n, e, en);
+        return context.from_montgomery(narrow(result.begin()));
+    }
+    big_integer reduced = base % modulus;
+    if (reduced.sign < 0) {
+        reduced += modulus;
+    }
+    divisor_context context(modulus);
+    auto mul = [&](ui* r, ui const* a, ui const* b) {
+        uint_array product = widen(context.mul(narrow(a), narrow(b)));
+        std::copy(product.begin(), product.end(), r);
+    };
+    fixed_window_power(mul, result.begin(), widen(context.one()).begin(), widen(reduced).begin(), n, e, en);
+    return narrow(result.begin());
+}
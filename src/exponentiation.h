@@ -0,0 +1,21 @@
+#ifndef BIGINT_EXPONENTIATION_H
+#define BIGINT_EXPONENTIATION_H
+
+#include "big_integer.h"
+
+// base^exponent mod modulus in [0, modulus), for exponent >= 0 and
+// modulus > 0. Sliding-window exponentiation over Montgomery reduction for
+// odd moduli and over a prepared big_divisor for even ones.
+big_integer powmod(big_integer const& base, big_integer const& exponent, big_integer const& modulus);
+
+// The same value with a fixed 4-bit window: the sequence of products depends
+// only on the limb count of the exponent, every limb of every table entry is
+// read for every window, and residues stay the limb count of the modulus.
+// For odd moduli the products are montgomery_context::mul_fixed(), so the
+// running time does not depend on the exponent's value; meant for secret
+// exponents. Even moduli reduce through big_divisor, which is not
+// constant-time.
+big_integer powmod_constant_time(big_integer const& base, big_integer const& exponent,
+                                 big_integer const& modulus);
+
+#endif //BIGINT_EXPONENTIATION_H
@@ -0,0 +1,167 @@
+#include "montgomery.h"
+#include "multiplication.h"
+#include <cassert>
+
+typedef limb_t ui;
+typedef double_limb_t ull;
+
+typedef data uint_array;
+
+// r[0..n) = x[0..n] - m[0..n) when that is not negative, else x[0..n); x[n]
+// is 0 or 1 and r must not overlap x. Both are computed and the choice is
+// made by a mask, so the time does not depend on it.
+static void subtract_if_not_less(ui* r, ui const* x, ui const* m, size_t n) {
+    ui borrow = 0;
+    for (size_t j = 0; j < n; ++j) {
+        ull difference = (ull) x[j] - m[j] - borrow;
+        r[j] = (ui) difference;
+        borrow = (ui) (difference >> LIMB_BITS) & 1u;
+    }
+    ui keep = 0u - (ui) (x[n] < borrow);
+    for (size_t j = 0; j < n; ++j) {
+        r[j] = (r[j] & ~keep) | (x[j] & keep);
+    }
+}
+
+montgomery_context::montgomery_context(big_integer const& modulus) : value(modulus), limbs(modulus.digits) {
+    assert(modulus.sign > 0 && (modulus.digits[0] & 1u) != 0 && modulus != 1);
+    // -N^-1 mod B by Newton iteration from the 3 bits x = N already has right,
+    // each step doubling the correct bits.
+    ui n0 = limbs[0], x = n0;
+    for (unsigned bits = 3; bits < LIMB_BITS; bits *= 2) {
+        x *= 2 - n0 * x;
+    }
+    inverse = 0u - x;
+    size_t n = limbs.size();
+    r_mod = (big_integer(1) << (int) (LIMB_BITS * n)) % value;
+    r_squared = (big_integer(1) << (int) (2 * LIMB_BITS * n)) % value;
+}
+
+big_integer const& montgomery_context::modulus() const {
+    return value;
+}
+
+big_integer const& montgomery_context::one() const {
+    return r_mod;
+}
+
+big_integer montgomery_context::to_montgomery(big_integer const& a) const {
+    big_integer reduced = a % value;
+    if (reduced.sign < 0) {
+        reduced += value;
+    }
+    return mul(reduced, r_squared);
+}
+
+big_integer montgomery_context::from_montgomery(big_integer const& a) const {
+    uint_array t(2 * limbs.size() + 1, 0);
+    std::copy(a.digits.begin(), a.digits.end(), t.begin());
+    return reduce(t);
+}
+
+big_integer montgomery_context::mul(big_integer const& a, big_integer const& b) const {
+    size_t n = limbs.size();
+    uint_array t(2 * n + 1, 0);
+    multiply(t.begin(), a.digits.begin(), a.digits.size(), b.digits.begin(), b.digits.size());
+    return reduce(t);
+}
+
+big_integer montgomery_context::sqr(big_integer const& a) const {
+    size_t n = limbs.size();
+    uint_array t(2 * n + 1, 0);
+    square(t.begin(), a.digits.begin(), a.digits.size());
+    return reduce(t);
+}
+
+big_integer montgomery_context::add(big_integer const& a, big_integer const& b) const {
+    big_integer sum = a + b;
+    if (sum >= value) {
+        sum -= value;
+    }
+    return sum;
+}
+
+big_integer montgomery_context::sub(big_integer const& a, big_integer const& b) const {
+    big_integer difference = a - b;
+    if (difference.sign < 0) {
+        difference += value;
+    }
+    return difference;
+}
+
+big_integer montgomery_context::pow(big_integer const& a, big_integer const& exponent) const {
+    assert(exponent.sign > 0);
+    big_integer result = r_mod;
+    bool started = false;
+    for (size_t i = exponent.digits.size(); i--;) {
+        for (ui bit = (ui) 1 << (LIMB_BITS - 1); bit != 0; bit >>= 1u) {
+            if (started) {
+                result = sqr(result);
+            }
+            if ((exponent.digits[i] & bit) != 0) {
+                result = started ? mul(result, a) : a;
+                started = true;
+            }
+        }
+    }
+    return result;
+}
+
+// Coarsely integrated operand scanning: each pass adds a * b[i], then the
+// multiple of N that clears the lowest limb, and shifts down by one limb.
+// x stays below 2N, so n + 1 limbs hold it between passes.
+void montgomery_context::mul_fixed(ui* r, ui const* a, ui const* b) const {
+    size_t n = limbs.size();
+    ui const* m = limbs.begin();
+    uint_array t(n + 2, 0);
+    ui* x = t.begin();
+    for (size_t i = 0; i < n; ++i) {
+        ull propagate = 0;
+        for (size_t j = 0; j < n; ++j) {
+            propagate += (ull) a[j] * b[i] + x[j];
+            x[j] = (ui) propagate;
+            propagate >>= LIMB_BITS;
+        }
+        propagate += x[n];
+        x[n] = (ui) propagate;
+        x[n + 1] = (ui) (propagate >> LIMB_BITS);
+
+        ui u = x[0] * inverse;
+        propagate = ((ull) u * m[0] + x[0]) >> LIMB_BITS;
+        for (size_t j = 1; j < n; ++j) {
+            propagate += (ull) u * m[j] + x[j];
+            x[j - 1] = (ui) propagate;
+            propagate >>= LIMB_BITS;
+        }
+        propagate += x[n];
+        x[n - 1] = (ui) propagate;
+        x[n] = x[n + 1] + (ui) (propagate >> LIMB_BITS);
+    }
+    subtract_if_not_less(r, x, m, n);
+}
+
+// REDC: t * R^-1 mod N for t < N * R held in 2n + 1 limbs, the top one zero.
+// Each step adds the multiple of N that clears the lowest remaining limb.
+big_integer montgomery_context::reduce(uint_array& t) const {
+    size_t n = limbs.size();
+    ui* x = t.begin();
+    ui const* m = limbs.begin();
+    for (size_t i = 0; i < n; ++i) {
+        ui u = x[i] * inverse;
+        ull propagate = 0;
+        for (size_t j = 0; j < n; ++j) {
+            propagate += (ull) u * m[j] + x[i + j];
+            x[i + j] = (ui) propagate;
+            propagate >>= LIMB_BITS;
+        }
+        for (size_t j = i + n; propagate != 0; ++j) {
+            propagate += x[j];
+            x[j] = (ui) propagate;
+            propagate >>= LIMB_BITS;
+        }
+    }
+    // x[n..2n] < 2N: one masked subtraction.
+    uint_array result(n);
+    subtract_if_not_less(result.begin(), x + n, m, n);
+    return big_integer(1, result);
+}
@@ -0,0 +1,45 @@
+#ifndef BIGINT_MONTGOMERY_H
+#define BIGINT_MONTGOMERY_H
+
+#include "big_integer.h"
+#include "data.h"
+
+// Arithmetic modulo an odd modulus N of n limbs in Montgomery form, where x
+// stands for x * R mod N with R = 2^(LIMB_BITS * n). Products are reduced by
+// REDC, one pass of word multiplications, so only the conversions divide.
+// Every argument except those of to_montgomery() and pow()'s exponent must
+// be in Montgomery form, that is in [0, N).
+class montgomery_context {
+public:
+    explicit montgomery_context(big_integer const& modulus);
+
+    big_integer const& modulus() const;
+
+    big_integer to_montgomery(big_integer const& a) const;
+    big_integer from_montgomery(big_integer const& a) const;
+    // R mod N, the Montgomery form of 1.
+    big_integer const& one() const;
+
+    big_integer mul(big_integer const& a, big_integer const& b) const;
+    big_integer sqr(big_integer const& a) const;
+    big_integer add(big_integer const& a, big_integer const& b) const;
+    big_integer sub(big_integer const& a, big_integer const& b) const;
+    // a^exponent for exponent >= 0.
+    big_integer pow(big_integer const& a, big_integer const& exponent) const;
+
+    // mul() on residues held in exactly n limbs, untrimmed, into r[0..n),
+    // which may alias a or b. The running time depends on n alone: the
+    // product is interleaved with REDC and the final subtraction is masked.
+    void mul_fixed(limb_t* r, limb_t const* a, limb_t const* b) const;
+
+private:
+    big_integer value;
+    data limbs;
+    limb_t inverse;
+    big_integer r_mod;
+    big_integer r_squared;
+
+    big_integer reduce(data& t) const;
+};
+
+#endif //BIGINT_MONTGOMERY_H
@@ -0,0 +1,719 @@
+#include "multiplication.h"
+#include "data.h"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+typedef limb_t ui;
+typedef double_limb_t ull;
+
+// r[0..rn) += a[0..an), an <= rn; returns the carry out of the top limb.
+static ui add_to(ui* r, size_t rn, ui const* a, size_t an) {
+    ull propagate = 0;
+    size_t i = 0;
+    for (; i < an; ++i) {
+        propagate += (ull) r[i] + a[i];
+        r[i] = (ui) propagate;
+        propagate >>= LIMB_BITS;
+    }
+    for (; propagate != 0 && i < rn; ++i) {
+        propagate += r[i];
+        r[i] = (ui) propagate;
+        propagate >>= LIMB_BITS;
+    }
+    return (ui) propagate;
+}
+
+// r[0..rn) -= a[0..an), an <= rn; returns the borrow out of the top limb.
+static ui sub_from(ui* r, size_t rn, ui const* a, size_t an) {
+    ui propagate = 0;
+    size_t i = 0;
+    for (; i < an; ++i) {
+        ull tmp = (ull) a[i] + propagate;
+        propagate = (ui) (r[i] < tmp);
+        r[i] -= (ui) tmp;
+    }
+    for (; propagate != 0 && i < rn; ++i) {
+        propagate = (ui) (r[i] == 0);
+        r[i] -= 1;
+    }
+    return propagate;
+}
+
+// Sum of a[0..n) and b[0..m), m <= n, written to r[0..n] (n + 1 limbs).
+static void add_into(ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    std::copy(a, a + n, r);
+    r[n] = add_to(r, n, b, m);
+}
+
+void mul_schoolbook(ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    std::fill(r, r + n + m, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ull digit = a[i];
+        ull propagate = 0;
+        for (size_t j = 0; j < m; ++j) {
+            propagate += digit * b[j] + r[i + j];
+            r[i + j] = (ui) propagate;
+            propagate >>= LIMB_BITS;
+        }
+        r[i + m] = (ui) propagate;
+    }
+}
+
+void sqr_schoolbook(ui* r, ui const* a, size_t n) {
+    // Each product a[i] * a[j], i < j, is computed once and then doubled.
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ull digit = a[i];
+        ull propagate = 0;
+        for (size_t j = i + 1; j < n; ++j) {
+            propagate += digit * a[j] + r[i + j];
+            r[i + j] = (ui) propagate;
+            propagate >>= LIMB_BITS;
+        }
+        r[i + n] = (ui) propagate;
+    }
+    ui top = 0;
+    for (size_t i = 0; i < 2 * n; ++i) {
+        ui digit = r[i];
+        r[i] = (digit << 1u) | top;
+        top = digit >> (LIMB_BITS - 1);
+    }
+    ull propagate = 0;
+    for (size_t i = 0; i < n; ++i) {
+        ull square = (ull) a[i] * a[i];
+        propagate += (ull) r[2 * i] + (ui) square;
+        r[2 * i] = (ui) propagate;
+        propagate >>= LIMB_BITS;
+        propagate += (ull) r[2 * i + 1] + (square >> LIMB_BITS);
+        r[2 * i + 1] = (ui) propagate;
+        propagate >>= LIMB_BITS;
+    }
+}
+
+void mul_karatsuba(ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    size_t h = (n + 1) / 2;
+    assert(m > h);
+
+    // a = a1 * B^h + a0, b = b1 * B^h + b0
+    multiply(r, a, h, b, h);
+    multiply(r + 2 * h, a + h, n - h, b + h, m - h);
+
+    data sum_a(h + 1), sum_b(h + 1), middle(2 * h + 2);
+    add_into(sum_a.begin(), a, h, a + h, n - h);
+    add_into(sum_b.begin(), b, h, b + h, m - h);
+    multiply(middle.begin(), sum_a.begin(), h + 1, sum_b.begin(), h + 1);
+
+    // (a0 + a1)(b0 + b1) - a0 * b0 - a1 * b1 = a0 * b1 + a1 * b0
+    ui* mid = middle.begin();
+    sub_from(mid, 2 * h + 2, r, 2 * h);
+    sub_from(mid, 2 * h + 2, r + 2 * h, n + m - 2 * h);
+
+    size_t len = std::min(2 * h + 2, n + m - h);
+    assert(std::all_of(mid + len, mid + 2 * h + 2, [](ui x) { return x == 0; }));
+    ui propagate = add_to(r + h, n + m - h, mid, len);
+    assert(propagate == 0);
+    (void) propagate;
+}
+
+void sqr_karatsuba(ui* r, ui const* a, size_t n) {
+    size_t h = (n + 1) / 2;
+    assert(n > h);
+
+    square(r, a, h);
+    square(r + 2 * h, a + h, n - h);
+
+    data sum(h + 1), middle(2 * h + 2);
+    add_into(sum.begin(), a, h, a + h, n - h);
+    square(middle.begin(), sum.begin(), h + 1);
+
+    // (a0 + a1)^2 - a0^2 - a1^2 = 2 * a0 * a1
+    ui* mid = middle.begin();
+    sub_from(mid, 2 * h + 2, r, 2 * h);
+    sub_from(mid, 2 * h + 2, r + 2 * h, 2 * n - 2 * h);
+
+    size_t len = std::min(2 * h + 2, 2 * n - h);
+    assert(std::all_of(mid + len, mid + 2 * h + 2, [](ui x) { return x == 0; }));
+    ui propagate = add_to(r + h, 2 * n - h, mid, len);
+    assert(propagate == 0);
+    (void) propagate;
+}
+
+// a is at least twice as long as b: multiply b by m-limb slices of a.
+static void mul_unbalanced(ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    std::fill(r, r + n + m, 0);
+    data product(2 * m);
+    for (size_t i = 0; i < n; i += m) {
+        size_t len = std::min(m, n - i);
+        multiply(product.begin(), a + i, len, b, m);
+        add_to(r + i, n + m - i, product.begin(), len + m);
+    }
+}
+
+// Toom-Cook works on fixed-size buffers: every point value of a factor has
+// s + 1 limbs and every point product and product coefficient 2s + 2, which
+// holds all of them for at most four parts per factor.
+
+// Length of part i when a[0..n) is cut into parts of s limbs; the last parts
+// may be shorter or empty.
+static size_t part_size(size_t n, size_t i, size_t s) {
+    return i * s >= n ? 0 : std::min(s, n - i * s);
+}
+
+// r[0..rn) += a[0..an) * 2^bits, an <= rn, bits < LIMB_BITS; a may be r.
+static void add_shifted(ui* r, size_t rn, ui const* a, size_t an, unsigned bits) {
+    ull propagate = 0;
+    ui top = 0;
+    size_t i = 0;
+    for (; i < an; ++i) {
+        ui digit = a[i];
+        propagate += (ull) r[i] + (ui) (digit << bits | top);
+        top = (digit >> 1u) >> (LIMB_BITS - 1 - bits);
+        r[i] = (ui) propagate;
+        propagate >>= LIMB_BITS;
+    }
+    propagate += top;
+    for (; propagate != 0 && i < rn; ++i) {
+        propagate += r[i];
+        r[i] = (ui) propagate;
+        propagate >>= LIMB_BITS;
+    }
+    assert(propagate == 0);
+}
+
+// r[0..rn) -= a[0..an) * 2^bits, an <= rn, bits < LIMB_BITS; the result is not negative.
+static void sub_shifted(ui* r, size_t rn, ui const* a, size_t an, unsigned bits) {
+    ull propagate = 0;
+    ui top = 0;
+    size_t i = 0;
+    for (; i < an; ++i) {
+        ui digit = a[i];
+        propagate += (ui) (digit << bits | top);
+        top = (digit >> 1u) >> (LIMB_BITS - 1 - bits);
+        ui subtrahend = (ui) propagate;
+        propagate = (propagate >> LIMB_BITS) + (r[i] < subtrahend);
+        r[i] -= subtrahend;
+    }
+    propagate += top;
+    for (; propagate != 0 && i < rn; ++i) {
+        auto subtrahend = (ui) propagate;
+        propagate = (propagate >> LIMB_BITS) + (r[i] < subtrahend);
+        r[i] -= subtrahend;
+    }
+    assert(propagate == 0);
+}
+
+// x[0..n) = y[0..n) - x[0..n), not negative.
+static void sub_reverse(ui* x, ui const* y, size_t n) {
+    ui propagate = 0;
+    for (size_t i = 0; i < n; ++i) {
+        ull tmp = (ull) x[i] + propagate;
+        propagate = (ui) (y[i] < tmp);
+        x[i] = y[i] - (ui) tmp;
+    }
+    assert(propagate == 0);
+}
+
+static void shift_left(ui* x, size_t n, unsigned bits) {
+    ui top = 0;
+    for (size_t i = 0; i < n; ++i) {
+        ui digit = x[i];
+        x[i] = digit << bits | top;
+        top = digit >> (LIMB_BITS - bits);
+    }
+    assert(top == 0);
+}
+
+// x[0..n) >>= bits, 0 < bits < LIMB_BITS, dropping bits known to be zero.
+static void shift_right(ui* x, size_t n, unsigned bits) {
+    assert((x[0] & ((ui(1) << bits) - 1)) == 0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        x[i] = x[i] >> bits | x[i + 1] << (LIMB_BITS - bits);
+    }
+    x[n - 1] >>= bits;
+}
+
+// x[0..n) /= d for an odd d known to divide it: multiply each limb by the
+// inverse of d modulo B instead of dividing the double limb.
+static void divide_exact(ui* x, size_t n, ui d) {
+    ui inverse = d;
+    for (unsigned bits = 3; bits < LIMB_BITS; bits *= 2) {
+        inverse *= 2 - d * inverse;
+    }
+    ui propagate = 0;
+    for (size_t i = 0; i < n; ++i) {
+        ui digit = x[i];
+        ui quotient = (ui) (digit - propagate) * inverse;
+        x[i] = quotient;
+        propagate = (ui) (digit < propagate) + (ui) (((ull) quotient * d) >> LIMB_BITS);
+    }
+    assert(propagate == 0);
+}
+
+static int compare(ui const* x, ui const* y, size_t n) {
+    for (size_t i = n; i--;) {
+        if (x[i] != y[i]) {
+            return x[i] < y[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// p = a(x) and m = |a(-x)| for x = 2^shift, shift 0 or 1, where a(x) has the k
+// parts of s limbs of a[0..n) as coefficients. Returns whether a(-x) < 0.
+static bool evaluate_pm(ui* p, ui* m, ui const* a, size_t n, size_t k, size_t s, unsigned shift) {
+    size_t l = s + 1;
+    std::fill(p, p + l, 0);
+    std::fill(m, m + l, 0);
+    for (size_t i = 0; i < k; ++i) {
+        add_shifted(i % 2 == 0 ? p : m, l, a + i * s, part_size(n, i, s), (unsigned) i * shift);
+    }
+    // p and m hold the even and odd terms E and O; a(x) = 2E + (O - E) = 2E - (E - O).
+    bool negative = compare(p, m, l) < 0;
+    if (negative) {
+        sub_from(m, l, p, l);
+        shift_left(p, l, 1);
+        add_to(p, l, m, l);
+    } else {
+        sub_reverse(m, p, l);
+        shift_left(p, l, 1);
+        sub_from(p, l, m, l);
+    }
+    return negative;
+}
+
+// p = a(2) by Horner's rule.
+static void evaluate_2(ui* p, ui const* a, size_t n, size_t k, size_t s) {
+    std::fill(p, p + s + 1, 0);
+    for (size_t i = k; i--;) {
+        shift_left(p, s + 1, 1);
+        add_to(p, s + 1, a + i * s, part_size(n, i, s));
+    }
+}
+
+// p = 8 * a(1/2), the sum of the parts times 8, 4, 2 and 1.
+static void evaluate_half(ui* p, ui const* a, size_t n, size_t s) {
+    std::fill(p, p + s + 1, 0);
+    for (size_t i = 0; i < 4; ++i) {
+        shift_left(p, s + 1, 1);
+        add_to(p, s + 1, a + i * s, part_size(n, i, s));
+    }
+}
+
+// Toom-3 for products of degree at most 4, from the points 0, 1, -1, 2 and
+// infinity. Interpolation follows Bodrato's sequence: one exact division by
+// 3, two halvings and subtractions.
+static void mul_toom_5(ui* r, ui const* a, size_t n, size_t ka, ui const* b, size_t m, size_t kb, size_t s) {
+    size_t const l = s + 1, w = 2 * s + 2;
+    bool squaring = a == b && n == m && ka == kb;
+    data scratch(3 * w + 4 * l);
+    ui* v1 = scratch.begin();
+    ui* vm1 = v1 + w;
+    ui* v2 = vm1 + w;
+    ui* ap = v2 + w;
+    ui* am = ap + l;
+    ui* bp = squaring ? ap : am + l;
+    ui* bm = squaring ? am : bp + l;
+
+    bool negative = evaluate_pm(ap, am, a, n, ka, s, 0);
+    negative = !squaring && negative != evaluate_pm(bp, bm, b, m, kb, s, 0);
+    multiply(v1, ap, l, bp, l);
+    multiply(vm1, am, l, bm, l);
+    evaluate_2(ap, a, n, ka, s);
+    if (!squaring) {
+        evaluate_2(bp, b, m, kb, s);
+    }
+    multiply(v2, ap, l, bp, l);
+
+    // The values at 0 and infinity are the outer coefficients and go straight to r.
+    std::fill(r, r + n + m, 0);
+    size_t a0 = part_size(n, 0, s), b0 = part_size(m, 0, s);
+    size_t at = part_size(n, ka - 1, s), bt = part_size(m, kb - 1, s);
+    size_t inf = ka + kb - 2 == 4 && at != 0 && bt != 0 ? at + bt : 0;
+    ui* v0 = r;
+    ui* vinf = r + 4 * s;
+    multiply(v0, a, a0, b, b0);
+    if (inf != 0) {
+        multiply(vinf, a + (ka - 1) * s, at, b + (kb - 1) * s, bt);
+    }
+
+    // v2 = (v(2) - v(-1)) / 3 = c1 + c2 + 3c3 + 5c4
+    if (negative) {
+        add_to(v2, w, vm1, w);
+    } else {
+        sub_from(v2, w, vm1, w);
+    }
+    divide_exact(v2, w, 3);
+    // vm1 = (v(1) - v(-1)) / 2 = c1 + c3
+    if (negative) {
+        add_to(vm1, w, v1, w);
+    } else {
+        sub_reverse(vm1, v1, w);
+    }
+    shift_right(vm1, w, 1);
+    // v1 = v(1) - c0 = c1 + c2 + c3 + c4
+    sub_from(v1, w, v0, a0 + b0);
+    // v2 = (v2 - v1) / 2 = c3 + 2c4
+    sub_from(v2, w, v1, w);
+    shift_right(v2, w, 1);
+    sub_from(v1, w, vm1, w);
+    sub_from(v1, w, vinf, inf);
+    sub_shifted(v2, w, vinf, inf, 1);
+    sub_from(vm1, w, v2, w);
+
+    ui* middle[] = {vm1, v1, v2};
+    for (size_t i = 1; i < 4 && i * s < n + m; ++i) {
+        ui propagate = add_to(r + i * s, n + m - i * s, middle[i - 1], std::min(w, n + m - i * s));
+        assert(propagate == 0);
+        (void) propagate;
+    }
+}
+
+// Toom-4 for products of degree 5 or 6, from the points 0, 1, -1, 2, -2, 1/2
+// and infinity. Every step of the interpolation leaves a non-negative
+// combination of the coefficients, so only the values at -1 and -2 carry a sign.
+static void mul_toom_7(ui* r, ui const* a, size_t n, size_t ka, ui const* b, size_t m, size_t kb, size_t s) {
+    size_t const l = s + 1, w = 2 * s + 2;
+    bool squaring = a == b && n == m && ka == kb;
+    data scratch(5 * w + 4 * l);
+    ui* v1 = scratch.begin();
+    ui* vm1 = v1 + w;
+    ui* v2 = vm1 + w;
+    ui* vm2 = v2 + w;
+    ui* vh = vm2 + w;
+    ui* ap = vh + w;
+    ui* am = ap + l;
+    ui* bp = squaring ? ap : am + l;
+    ui* bm = squaring ? am : bp + l;
+
+    bool negative1 = evaluate_pm(ap, am, a, n, ka, s, 0);
+    negative1 = !squaring && negative1 != evaluate_pm(bp, bm, b, m, kb, s, 0);
+    multiply(v1, ap, l, bp, l);
+    multiply(vm1, am, l, bm, l);
+    bool negative2 = evaluate_pm(ap, am, a, n, ka, s, 1);
+    negative2 = !squaring && negative2 != evaluate_pm(bp, bm, b, m, kb, s, 1);
+    multiply(v2, ap, l, bp, l);
+    multiply(vm2, am, l, bm, l);
+    evaluate_half(ap, a, n, s);
+    if (!squaring) {
+        evaluate_half(bp, b, m, s);
+    }
+    multiply(vh, ap, l, bp, l);
+
+    std::fill(r, r + n + m, 0);
+    size_t a0 = part_size(n, 0, s), b0 = part_size(m, 0, s);
+    size_t at = part_size(n, ka - 1, s), bt = part_size(m, kb - 1, s);
+    size_t inf = ka + kb - 2 == 6 && at != 0 && bt != 0 ? at + bt : 0;
+    ui* v0 = r;
+    ui* vinf = r + 6 * s;
+    multiply(v0, a, a0, b, b0);
+    if (inf != 0) {
+        multiply(vinf, a + (ka - 1) * s, at, b + (kb - 1) * s, bt);
+    }
+
+    // vm1 = 2(c0 + c2 + c4 + c6), v1 = 2(c1 + c3 + c5); the same at 2 with
+    // vm2 = 2(c0 + 4c2 + 16c4 + 64c6), v2 = 4(c1 + 4c3 + 16c5).
+    if (negative1) {
+        sub_reverse(vm1, v1, w);
+    } else {
+        add_to(vm1, w, v1, w);
+    }
+    shift_left(v1, w, 1);
+    sub_from(v1, w, vm1, w);
+    shift_right(v1, w, 1);
+    shift_right(vm1, w, 1);
+    if (negative2) {
+        sub_reverse(vm2, v2, w);
+    } else {
+        add_to(vm2, w, v2, w);
+    }
+    shift_left(v2, w, 1);
+    sub_from(v2, w, vm2, w);
+    shift_right(v2, w, 2);
+    shift_right(vm2, w, 1);
+
+    // Even coefficients: vm1 = c2 + c4, vm2 = c2 + 4c4, then c4 and c2.
+    sub_from(vm1, w, v0, a0 + b0);
+    sub_from(vm1, w, vinf, inf);
+    sub_from(vm2, w, v0, a0 + b0);
+    shift_right(vm2, w, 2);
+    sub_shifted(vm2, w, vinf, inf, 4);
+    sub_from(vm2, w, vm1, w);
+    divide_exact(vm2, w, 3);
+    sub_from(vm1, w, vm2, w);
+
+    // Odd coefficients: vh = (v(1/2) - 64c0 - 16c2 - 4c4 - c6) / 2 = 16c1 + 4c3 + c5.
+    sub_shifted(vh, w, v0, a0 + b0, 6);
+    sub_shifted(vh, w, vm1, w, 4);
+    sub_shifted(vh, w, vm2, w, 2);
+    sub_from(vh, w, vinf, inf);
+    shift_right(vh, w, 1);
+    // vh = 5c1 + c3, v2 = c3 + 5c5 and v1 = 5(c1 + c3 + c5) - vh - v2 = 3c3.
+    sub_from(vh, w, v1, w);
+    divide_exact(vh, w, 3);
+    sub_from(v2, w, v1, w);
+    divide_exact(v2, w, 3);
+    add_shifted(v1, w, v1, w, 2);
+    sub_from(v1, w, v2, w);
+    sub_from(v1, w, vh, w);
+    divide_exact(v1, w, 3);
+    sub_from(v2, w, v1, w);
+    divide_exact(v2, w, 5);
+    sub_from(vh, w, v1, w);
+    divide_exact(vh, w, 5);
+
+    ui* middle[] = {vh, vm1, v1, vm2, v2};
+    for (size_t i = 1; i < 6 && i * s < n + m; ++i) {
+        ui propagate = add_to(r + i * s, n + m - i * s, middle[i - 1], std::min(w, n + m - i * s));
+        assert(propagate == 0);
+        (void) propagate;
+    }
+}
+
+void mul_toom(ui* r, ui const* a, size_t n, size_t ka, ui const* b, size_t m, size_t kb) {
+    assert(ka >= 2 && kb >= 2 && ka <= 4 && kb <= 4);
+    size_t s = std::max((n + ka - 1) / ka, (m + kb - 1) / kb);
+    if (ka + kb - 2 <= 4) {
+        mul_toom_5(r, a, n, ka, b, m, kb, s);
+    } else {
+        mul_toom_7(r, a, n, ka, b, m, kb, s);
+    }
+}
+
+// The transform computes in 32-bit words whatever the limb size.
+typedef unsigned int u32;
+typedef unsigned long long u64;
+
+// NTT-friendly primes c * 2^k + 1, all with primitive root 3. The smallest k
+// is 23, which bounds the transform length; their product exceeds 2^86, enough
+// to hold any convolution coefficient of at most 2^22 products of two words.
+u32 static const NTT_P1 = 998244353;
+u32 static const NTT_P2 = 167772161;
+u32 static const NTT_P3 = 469762049;
+
+template <u32 MOD>
+static u32 power_mod(u64 base, u64 exponent) {
+    u64 result = 1;
+    base %= MOD;
+    for (; exponent != 0; exponent >>= 1u) {
+        if (exponent & 1u) {
+            result = result * base % MOD;
+        }
+        base = base * base % MOD;
+    }
+    return (u32) result;
+}
+
+// -MOD^-1 mod 2^32 by Newton's iteration, for Montgomery reduction.
+template <u32 MOD>
+static constexpr u32 negated_inverse() {
+    u32 inverse = MOD;
+    for (int i = 0; i < 4; ++i) {
+        inverse *= 2 - MOD * inverse;
+    }
+    return 0u - inverse;
+}
+
+// a * b / 2^32 mod MOD for a, b < MOD. The reductions below use
+// min(x, x - MOD), which wraps around when x < MOD, to stay branch-free:
+// butterfly outputs are random and a conditional jump mispredicts half the time.
+template <u32 MOD>
+static inline u32 montgomery_mul(u32 a, u32 b) {
+    u64 t = (u64) a * b;
+    u32 k = (u32) t * negated_inverse<MOD>();
+    auto u = (u32) ((t + (u64) k * MOD) >> 32u);
+    return std::min(u, u - MOD);
+}
+
+// Powers of the 2 * half-th root of unity for every stage, root[half + k] = w^k,
+// kept in Montgomery form so the butterflies multiply plain residues by them.
+template <u32 MOD>
+static void ntt_roots(u32* root, size_t len, bool invert) {
+    u64 const r = (1ull << 32u) % MOD;
+    for (size_t half = 1; half < len; half <<= 1u) {
+        u64 step = power_mod<MOD>(3, (MOD - 1) / (2 * half));
+        if (invert) {
+            step = power_mod<MOD>(step, MOD - 2);
+        }
+        auto step_m = (u32) ((step << 32u) % MOD);
+        root[half] = (u32) r;
+        for (size_t k = 1; k < half; ++k) {
+            root[half + k] = montgomery_mul<MOD>(root[half + k - 1], step_m);
+        }
+    }
+}
+
+// In-place unscaled transform of a[0..len), len a power of two.
+template <u32 MOD>
+static void ntt(u32* a, size_t len, u32 const* root) {
+    for (size_t i = 1, j = 0; i < len; ++i) {
+        size_t bit = len >> 1u;
+        for (; j & bit; bit >>= 1u) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (size_t half = 1; half < len; half <<= 1u) {
+        for (size_t i = 0; i < len; i += 2 * half) {
+            for (size_t k = 0; k < half; ++k) {
+                u32 u = a[i + k];
+                u32 v = montgomery_mul<MOD>(a[i + k + half], root[half + k]);
+                a[i + k] = std::min(u + v, u + v - MOD);
+                a[i + k + half] = std::min(u - v + MOD, u - v);
+            }
+        }
+    }
+}
+
+// The n + m - 1 coefficients of a * b as polynomials in B, modulo MOD.
+template <u32 MOD>
+static void convolution(u32* out, u32 const* a, size_t n, u32 const* b, size_t m, size_t len) {
+    std::vector<u32> transform_a(len), transform_b(len), roots(len);
+    u32* x = transform_a.data();
+    u32* y = transform_b.data();
+    u32* root = roots.data();
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = a[i] % MOD;
+    }
+    bool squaring = a == b && n == m;
+    for (size_t i = 0; i < m && !squaring; ++i) {
+        y[i] = b[i] % MOD;
+    }
+    ntt_roots<MOD>(root, len, false);
+    ntt<MOD>(x, len, root);
+    if (squaring) {
+        for (size_t i = 0; i < len; ++i) {
+            x[i] = montgomery_mul<MOD>(x[i], x[i]);
+        }
+    } else {
+        ntt<MOD>(y, len, root);
+        for (size_t i = 0; i < len; ++i) {
+            x[i] = montgomery_mul<MOD>(x[i], y[i]);
+        }
+    }
+    ntt_roots<MOD>(root, len, true);
+    ntt<MOD>(x, len, root);
+
+    // The pointwise products lost a factor 2^32 and the inverse transform
+    // gained a factor len: multiply by 2^64 / len in Montgomery form.
+    u64 r = (1ull << 32u) % MOD;
+    auto scale = (u32) (r * r % MOD * power_mod<MOD>(len, MOD - 2) % MOD);
+    for (size_t i = 0; i < n + m - 1; ++i) {
+        out[i] = montgomery_mul<MOD>(x[i], scale);
+    }
+}
+
+static void mul_ntt_words(u32* r, u32 const* a, size_t n, u32 const* b, size_t m) {
+    size_t len = 1;
+    while (len < n + m - 1) {
+        len <<= 1u;
+    }
+    size_t count = n + m - 1;
+    std::vector<u32> residues(3 * count);
+    u32* c1 = residues.data();
+    u32* c2 = c1 + count;
+    u32* c3 = c2 + count;
+    convolution<NTT_P1>(c1, a, n, b, m, len);
+    convolution<NTT_P2>(c2, a, n, b, m, len);
+    convolution<NTT_P3>(c3, a, n, b, m, len);
+
+    // Garner's CRT: x = x1 + P1 * t2 + P1 * P2 * t3 < 2^87, spread over three
+    // limbs and added to the carry coming from the lower coefficients.
+    u64 const inv_p1 = power_mod<NTT_P2>(NTT_P1, NTT_P2 - 2);
+    u64 const inv_p1p2 = power_mod<NTT_P3>((u64) NTT_P1 * NTT_P2, NTT_P3 - 2);
+    u64 const p1p2 = (u64) NTT_P1 * NTT_P2;
+    u64 const mask = 0xFFFFFFFFu;
+    u64 propagate = 0;
+    for (size_t i = 0; i < count; ++i) {
+        u64 t2 = (c2[i] + NTT_P2 - c1[i] % NTT_P2) % NTT_P2 * inv_p1 % NTT_P2;
+        u64 v = c1[i] + NTT_P1 * t2;
+        u64 t3 = (c3[i] + NTT_P3 - v % NTT_P3) % NTT_P3 * inv_p1p2 % NTT_P3;
+        u64 lo = (p1p2 & mask) * t3;
+        u64 hi = (p1p2 >> 32u) * t3;
+        u64 w0 = (v & mask) + (lo & mask) + (propagate & mask);
+        u64 w1 = (v >> 32u) + (lo >> 32u) + (hi & mask) + (propagate >> 32u) + (w0 >> 32u);
+        u64 w2 = (hi >> 32u) + (w1 >> 32u);
+        r[i] = (u32) w0;
+        propagate = (w1 & mask) | (w2 << 32u);
+    }
+    assert((propagate >> 32u) == 0);
+    r[count] = (u32) propagate;
+}
+
+void mul_ntt(ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    assert(n + m <= NTT_MAX_LIMBS);
+#if BIGINT_LIMB_BITS == 32
+    mul_ntt_words(r, a, n, b, m);
+#else
+    // Each limb is split into two words, low word first.
+    bool squaring = a == b && n == m;
+    std::vector<u32> x(2 * n), y(squaring ? 0 : 2 * m), z(2 * (n + m));
+    for (size_t i = 0; i < n; ++i) {
+        x[2 * i] = (u32) a[i];
+        x[2 * i + 1] = (u32) (a[i] >> 32u);
+    }
+    for (size_t i = 0; i < y.size() / 2; ++i) {
+        y[2 * i] = (u32) b[i];
+        y[2 * i + 1] = (u32) (b[i] >> 32u);
+    }
+    mul_ntt_words(z.data(), x.data(), 2 * n, squaring ? x.data() : y.data(), 2 * m);
+    for (size_t i = 0; i < n + m; ++i) {
+        r[i] = z[2 * i] | (ui) z[2 * i + 1] << 32u;
+    }
+#endif
+}
+
+void square(ui* r, ui const* a, size_t n) {
+    if (n < SQR_KARATSUBA_THRESHOLD) {
+        sqr_schoolbook(r, a, n);
+    } else if (n >= NTT_THRESHOLD && 2 * n <= NTT_MAX_LIMBS) {
+        mul_ntt(r, a, n, a, n);
+    } else if (n < SQR_TOOM3_THRESHOLD) {
+        sqr_karatsuba(r, a, n);
+    } else if (n < TOOM4_THRESHOLD) {
+        mul_toom(r, a, n, 3, a, n, 3);
+    } else {
+        mul_toom(r, a, n, 4, a, n, 4);
+    }
+}
+
+void multiply(ui* r, ui const* a, size_t n, ui const* b, size_t m) {
+    if (a == b && n == m) {
+        square(r, a, n);
+        return;
+    }
+    if (n < m) {
+        std::swap(a, b);
+        std::swap(n, m);
+    }
+    if (m < KARATSUBA_THRESHOLD) {
+        mul_schoolbook(r, a, n, b, m);
+    } else if (m >= NTT_THRESHOLD && n + m <= NTT_MAX_LIMBS) {
+        mul_ntt(r, a, n, b, m);
+    } else if (m <= (n + 1) / 2) {
+        mul_unbalanced(r, a, n, b, m);
+    } else if (m < TOOM3_THRESHOLD) {
+        mul_karatsuba(r, a, n, b, m);
+    } else if (m < TOOM4_THRESHOLD) {
+        if (2 * n < 3 * m) {
+            mul_toom(r, a, n, 3, b, m, 3);
+        } else {
+            mul_toom(r, a, n, 3, b, m, 2);
+        }
+    } else {
+        if (4 * n < 5 * m) {
+            mul_toom(r, a, n, 4, b, m, 4);
+        } else if (4 * n < 7 * m) {
+            mul_toom(r, a, n, 4, b, m, 3);
+        } else {
+            mul_toom(r, a, n, 4, b, m, 2);
+        }
+    }
+}
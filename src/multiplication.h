@@ -0,0 +1,84 @@
+#ifndef BIGINT_MULTIPLICATION_H
+#define BIGINT_MULTIPLICATION_H
+
+#include "data.h"
+#include <cstddef>
+
+// Limb count of the shorter factor from which multiply() leaves the schoolbook
+// loop for Karatsuba. Below it the O(n^1.58) recursion loses to the plain
+// double loop because of its extra additions and scratch buffers; rerun
+// big_integer_benchmark and adjust it when moving to a different machine.
+size_t static const KARATSUBA_THRESHOLD = 40;
+
+// The same crossover for squaring, whose schoolbook loop does half the work.
+size_t static const SQR_KARATSUBA_THRESHOLD = 80;
+
+// Limb counts of the shorter factor from which Toom-3 and then Toom-4 take
+// over. Each tier also has unbalanced shapes (3x2, 4x3, 4x2 parts) chosen by
+// the ratio of the operand lengths. NTT_THRESHOLD is the limb count of the
+// shorter factor from which the number-theoretic transform is used, as long
+// as the product has at most NTT_MAX_LIMBS limbs, 2^23 32-bit words. Larger
+// products are split by the Toom-Cook tiers into pieces that fit.
+//
+// The transform works on 32-bit words whatever the limb width, so with
+// 64-bit limbs it costs twice as much per limb while the Toom-Cook tiers get
+// faster, and it takes over later. Its cost also steps up at every power of
+// two of the word count, so near the threshold it wins just below a step and
+// loses just above one.
+#if BIGINT_LIMB_BITS == 64
+size_t static const TOOM3_THRESHOLD = 200;
+size_t static const TOOM4_THRESHOLD = 1000;
+size_t static const NTT_THRESHOLD = 16000;
+#else
+size_t static const TOOM3_THRESHOLD = 200;
+size_t static const TOOM4_THRESHOLD = 800;
+size_t static const NTT_THRESHOLD = 4000;
+#endif
+
+// Toom-3 squaring has to beat the cheaper Karatsuba squaring, so it starts later.
+size_t static const SQR_TOOM3_THRESHOLD = 400;
+
+static_assert(KARATSUBA_THRESHOLD < TOOM3_THRESHOLD && TOOM3_THRESHOLD < TOOM4_THRESHOLD &&
+              TOOM4_THRESHOLD < NTT_THRESHOLD, "every multiplication tier needs a range of its own");
+static_assert(SQR_KARATSUBA_THRESHOLD < SQR_TOOM3_THRESHOLD && SQR_TOOM3_THRESHOLD < TOOM4_THRESHOLD,
+              "every squaring tier needs a range of its own");
+size_t static const NTT_MAX_LIMBS = (size_t(1) << 23u) / (LIMB_BITS / 32);
+
+// The kernels below work on little-endian limb arrays of non-zero length.
+// r receives all n + m limbs of the product, is overwritten completely and
+// must not overlap a or b.
+
+void mul_schoolbook(limb_t* r, limb_t const* a, size_t n, limb_t const* b, size_t m);
+
+// a^2 in 2 * n limbs, computing each cross product once.
+void sqr_schoolbook(limb_t* r, limb_t const* a, size_t n);
+
+// One level of Karatsuba splitting; the three half-size products go back
+// through multiply(), so n should not exceed 2 * m.
+void mul_karatsuba(limb_t* r, limb_t const* a, size_t n, limb_t const* b, size_t m);
+
+// Karatsuba squaring: three half-size squares, n >= 2.
+void sqr_karatsuba(limb_t* r, limb_t const* a, size_t n);
+
+// Toom-Cook with a split into ka and kb parts, 2 <= ka, kb <= 4: (3, 3) is
+// Toom-3, (3, 2) is Toom-2.5, (4, 4) is Toom-4. Products of degree up to 4
+// are evaluated at 0, 1, -1, 2 and infinity, longer ones also at -2 and 1/2.
+// Point values and coefficients live in one scratch buffer allocated per
+// call, and the point products go back through multiply(). Given the same
+// operand twice it evaluates it once and squares the point values.
+void mul_toom(limb_t* r, limb_t const* a, size_t n, size_t ka,
+              limb_t const* b, size_t m, size_t kb);
+
+// Convolution modulo three word-sized primes combined by the Chinese remainder
+// theorem; O((n + m) log(n + m)) for n + m <= NTT_MAX_LIMBS. Squares with
+// two transforms fewer when a == b.
+void mul_ntt(limb_t* r, limb_t const* a, size_t n, limb_t const* b, size_t m);
+
+// a^2 in 2 * n limbs, picking the algorithm from n.
+void square(limb_t* r, limb_t const* a, size_t n);
+
+// Picks the algorithm from the operand sizes; falls back to square() when a
+// and b are the same array.
+void multiply(limb_t* r, limb_t const* a, size_t n, limb_t const* b, size_t m);
+
+#endif //BIGINT_MULTIPLICATION_H
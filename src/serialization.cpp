@@ -0,0 +1,164 @@
+#include "serialization.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+typedef limb_t ui;
+
+typedef data uint_array;
+
+static endian resolve(endian e) {
+    if (e == endian::native) {
+        return little_endian_host() ? endian::little : endian::big;
+    }
+    return e;
+}
+
+static size_t bit_length(uint_array const& digits) {
+    size_t n = digits.size();
+    while (n > 0 && digits[n - 1] == 0) {
+        --n;
+    }
+    size_t bits = 8 * sizeof(ui) * n;
+    while (bits > 0 && (digits[n - 1] >> ((bits - 1) % (8 * sizeof(ui)))) == 0) {
+        --bits;
+    }
+    return bits;
+}
+
+size_t export_words(big_integer const& a, size_t word_size, sign_format sign) {
+    assert(word_size > 0);
+    size_t bits = bit_length(a.digits);
+    if (sign == sign_format::twos_complement) {
+        // -2^k fits in k + 1 bits like 2^k - 1 does.
+        bits = (a.sign < 0 ? bit_length((-a - 1).digits) : bits) + 1;
+    }
+    return (bits + 8 * word_size - 1) / (8 * word_size);
+}
+
+size_t export_bytes(unsigned char* out, big_integer const& a, size_t word_size, endian order, endian byte_order,
+                    sign_format sign) {
+    size_t count = export_words(a, word_size, sign);
+    size_t total = count * word_size;
+    ui const* d = a.digits.begin();
+    size_t n = a.digits.size();
+    bool negate = sign == sign_format::twos_complement && a.sign < 0;
+    order = resolve(order);
+    byte_order = word_size == 1 ? order : resolve(byte_order);
+    if (!negate && order == endian::little && byte_order == endian::little && little_endian_host()) {
+        size_t bytes = std::min(total, sizeof(ui) * n);
+        std::memcpy(out, d, bytes);
+        std::memset(out + bytes, 0, total - bytes);
+        return count;
+    }
+    ui carry = negate ? 1 : 0;
+    for (size_t j = 0; j < total; ++j) {
+        ui byte = j / sizeof(ui) < n ? (d[j / sizeof(ui)] >> (8 * (j % sizeof(ui)))) & 0xffu : 0;
+        if (negate) {
+            byte = (~byte & 0xffu) + carry;
+            carry = byte >> 8u;
+            byte &= 0xffu;
+        }
+        size_t word = j / word_size, offset = j % word_size;
+        if (order == endian::big) {
+            word = count - 1 - word;
+        }
+        if (byte_order == endian::big) {
+            offset = word_size - 1 - offset;
+        }
+        out[word * word_size + offset] = (unsigned char) byte;
+    }
+    return count;
+}
+
+big_integer import_bytes(unsigned char const* in, size_t count, size_t word_size, endian order, endian byte_order,
+                         sign_format sign) {
+    assert(word_size > 0);
+    size_t total = count * word_size;
+    order = resolve(order);
+    byte_order = word_size == 1 ? order : resolve(byte_order);
+    uint_array digits(std::max((total + sizeof(ui) - 1) / sizeof(ui), size_t(1)), 0);
+    ui* r = digits.begin();
+    if (order == endian::little && byte_order == endian::little && little_endian_host()) {
+        std::memcpy(r, in, total);
+    } else {
+        for (size_t j = 0; j < total; ++j) {
+            size_t word = j / word_size, offset = j % word_size;
+            if (order == endian::big) {
+                word = count - 1 - word;
+            }
+            if (byte_order == endian::big) {
+                offset = word_size - 1 - offset;
+            }
+            r[j / sizeof(ui)] |= (ui) in[word * word_size + offset] << (8 * (j % sizeof(ui)));
+        }
+    }
+    char result_sign = 1;
+    size_t top = total - 1;
+    if (sign == sign_format::twos_complement && total > 0 &&
+        ((r[top / sizeof(ui)] >> (8 * (top % sizeof(ui)) + 7)) & 1u) != 0) {
+        // The magnitude is 2^(8 * total) minus the words.
+        result_sign = -1;
+        ui carry = 1;
+        for (size_t i = 0; i < digits.size(); ++i) {
+            r[i] = ~r[i] + carry;
+            carry = r[i] < carry;
+        }
+        if (total % sizeof(ui) != 0) {
+            r[digits.size() - 1] &= (ui(1) << (8 * (total % sizeof(ui)))) - 1;
+        }
+    }
+    return big_integer(result_sign, digits);
+}
+
+size_t serialized_size(big_integer const& a) {
+    size_t n = export_words(a, 1);
+    size_t size = 2 + n;
+    for (uint64_t header = 2 * (uint64_t) n; header >= 0x80; header >>= 7u) {
+        ++size;
+    }
+    return size;
+}
+
+unsigned char* serialize(unsigned char* out, big_integer const& a) {
+    size_t n = export_words(a, 1);
+    *out++ = SERIALIZATION_VERSION;
+    uint64_t header = 2 * (uint64_t) n + (a.sign < 0 ? 1 : 0);
+    for (; header >= 0x80; header >>= 7u) {
+        *out++ = (unsigned char) (header | 0x80u);
+    }
+    *out++ = (unsigned char) header;
+    return out + export_bytes(out, a, 1, endian::little, endian::little);
+}
+
+unsigned char const* deserialize(unsigned char const* first, unsigned char const* last, big_integer& value) {
+    if (first == last || *first != SERIALIZATION_VERSION) {
+        return nullptr;
+    }
+    ++first;
+    uint64_t header = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        if (first == last) {
+            return nullptr;
+        }
+        unsigned char byte = *first++;
+        // Reject overflow past 64 bits and redundant zero groups.
+        if ((shift == 63 && byte > 1) || (shift > 0 && byte == 0)) {
+            return nullptr;
+        }
+        header |= (uint64_t) (byte & 0x7fu) << shift;
+        if ((byte & 0x80u) == 0) {
+            break;
+        }
+    }
+    uint64_t n = header >> 1u;
+    bool negative = (header & 1u) != 0;
+    if (n > (uint64_t) (last - first) || (n > 0 ? first[n - 1] == 0 : negative)) {
+        return nullptr;
+    }
+    value = import_bytes(first, (size_t) n, 1, endian::little, endian::little);
+    if (negative) {
+        value = -value;
+    }
+    return first + n;
+}
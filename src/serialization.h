@@ -0,0 +1,59 @@
+#ifndef BIGINT_SERIALIZATION_H
+#define BIGINT_SERIALIZATION_H
+
+#include "big_integer.h"
+#include <cstddef>
+#include <cstring>
+
+// Whether the host stores a limb least significant byte first.
+inline bool little_endian_host() {
+    limb_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+// Word order and byte order within a word for export_bytes() and
+// import_bytes(); native is the byte order of the host.
+enum class endian { little, big, native };
+
+// How the words carry the sign: not at all, so the magnitude is written and
+// read back as non-negative, or as two's complement over all of the words.
+enum class sign_format { magnitude, twos_complement };
+
+// The number of words of word_size bytes export_bytes() writes for a. In
+// magnitude format zero takes no words; two's complement keeps room for the
+// sign bit, so 128 takes two one-byte words and -128 one.
+size_t export_words(big_integer const& a, size_t word_size, sign_format sign = sign_format::magnitude);
+
+// mpz_export without nails: writes a to out as export_words(a, word_size,
+// sign) words of word_size bytes, most significant word first when order is
+// big, each word's bytes in byte_order, and returns the word count. Little
+// endian throughout on a little-endian host is a memcpy of the limbs.
+size_t export_bytes(unsigned char* out, big_integer const& a, size_t word_size, endian order, endian byte_order,
+                    sign_format sign = sign_format::magnitude);
+
+// mpz_import: the value of the count words at in, laid out as export_bytes()
+// writes them.
+big_integer import_bytes(unsigned char const* in, size_t count, size_t word_size, endian order, endian byte_order,
+                         sign_format sign = sign_format::magnitude);
+
+// The version byte serialize() writes and the only one deserialize() reads.
+unsigned char static const SERIALIZATION_VERSION = 1;
+
+// The bytes serialize() takes for a.
+size_t serialized_size(big_integer const& a);
+
+// The compact binary format: the version byte; then the byte length n of the
+// magnitude times two, plus one when negative, as a little-endian base-128
+// varint; then the n bytes of the magnitude, least significant first, with
+// no leading zero byte. On a little-endian host the payload is one memcpy of
+// the limbs each way. Writes serialized_size(a) bytes and returns their end.
+unsigned char* serialize(unsigned char* out, big_integer const& a);
+
+// Reads one serialized value from [first, last) and returns its end, or
+// nullptr with value untouched when the input is truncated, not canonical or
+// of another version.
+unsigned char const* deserialize(unsigned char const* first, unsigned char const* last, big_integer& value);
+
+#endif //BIGINT_SERIALIZATION_H
@@ -1,11 +1,27 @@
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
 #include <vector>
+#include <thread>
 #include <utility>
+#include <unistd.h>
 #include <test/gtest/gtest.h>
 
+#include "src/big_divisor.h"
 #include "src/big_integer.h"
+#include "src/big_integer_view.h"
+#include "src/conversion.h"
+#include "src/division.h"
+#include "src/exponentiation.h"
+#include "src/montgomery.h"
+#include "src/multiplication.h"
+#include "src/serialization.h"
 
 TEST(correctness, two_plus_two)
 {
@@ -56,6 +72,56 @@ TEST(correctness, copy_ctor_real_copy2)
     EXPECT_EQ(a, 3);
 }
 
+TEST(correctness, data_copy_on_write)
+{
+    data a(20, 7);
+    data b(a);
+    b.reserve(100);
+    EXPECT_GE(b.capacity(), 100u);
+    b[0] = 1;
+    EXPECT_EQ(a[0], 7u);
+    EXPECT_EQ(b.size(), 20u);
+    EXPECT_EQ(b[19], 7u);
+
+    data c(a);
+    c.pop_back();
+    c.push_back(3);
+    EXPECT_EQ(a.size(), 20u);
+    EXPECT_EQ(a[19], 7u);
+    EXPECT_EQ(c[19], 3u);
+
+    data d(a);
+    while (d.size() < d.capacity())
+        d.push_back(5);
+    d.push_back(6);
+    EXPECT_EQ(a.size(), 20u);
+    EXPECT_EQ(d[20], 5u);
+    EXPECT_EQ(d.back(), 6u);
+
+    data const shared(a);
+    data e = shared.clone();
+    EXPECT_EQ(e, a);
+    EXPECT_NE(static_cast<data const&>(e).begin(), shared.begin());
+}
+
+TEST(correctness, data_inline_limbs)
+{
+    data a(DEFAULT_SIZE, 1);
+    EXPECT_EQ(a.capacity(), DEFAULT_SIZE);
+    data b(a);
+    b.push_back(2);
+    EXPECT_GT(b.capacity(), DEFAULT_SIZE);
+    EXPECT_EQ(a.size(), DEFAULT_SIZE);
+    EXPECT_EQ(b[0], 1u);
+    EXPECT_EQ(b.back(), 2u);
+
+    big_integer x = (big_integer(1) << (int) (LIMB_BITS * DEFAULT_SIZE - 1)) + 1;
+    big_integer y = x;
+    y += x;
+    EXPECT_EQ(y, 2 * x);
+    EXPECT_EQ(y - x, x);
+}
+
 TEST(correctness, assignment_operator)
 {
     big_integer a = 4;
@@ -293,6 +359,20 @@ TEST(correctness, negation)
     EXPECT_TRUE(b == -666);
 }
 
+TEST(correctness, negation_shares_limbs)
+{
+    big_integer a = (big_integer(1) << 1000) + 1;
+    big_integer b = -a;
+    big_integer c = -b;
+    EXPECT_EQ(big_integer_view(b).limbs(), big_integer_view(a).limbs());
+    EXPECT_EQ(big_integer_view(c).limbs(), big_integer_view(a).limbs());
+
+    b -= 1;
+    EXPECT_NE(big_integer_view(b).limbs(), big_integer_view(a).limbs());
+    EXPECT_EQ(a, (big_integer(1) << 1000) + 1);
+    EXPECT_EQ(b, -(big_integer(1) << 1000) - 2);
+}
+
 TEST(correctness, negation_int_min)
 {
     big_integer a = std::numeric_limits<int>::min();
@@ -444,6 +524,24 @@ TEST(correctness, shr_signed)
     EXPECT_EQ(a, -155);
 }
 
+TEST(correctness, shr_past_all_limbs)
+{
+    big_integer a("123456789012345678901234567890");
+
+    EXPECT_EQ(a >> 128, 0);
+    EXPECT_EQ(a >> 200, 0);
+    EXPECT_EQ(-a >> 200, -1);
+    EXPECT_EQ(big_integer(5) >> 32, 0);
+}
+
+TEST(correctness, shr_carries_low_bits)
+{
+    big_integer a = (big_integer(1) << 200) + (big_integer(1) << 150) - 1;
+
+    for (int shift : {1, 31, 33, 45, 63})
+        EXPECT_EQ(a >> shift, a / (big_integer(1) << shift));
+}
+
 TEST(correctness, shr_return_value)
 {
     big_integer a = 64;
@@ -498,6 +596,13 @@ TEST(correctness, sub_long)
     EXPECT_EQ(a - b, c);
 }
 
+TEST(correctness, sub_long_borrow)
+{
+    big_integer a("340282366920938463463374607431768211456");
+    EXPECT_EQ(a - 1, big_integer("340282366920938463463374607431768211455"));
+    EXPECT_EQ(1 - a, big_integer("-340282366920938463463374607431768211455"));
+}
+
 TEST(correctness, mul_long)
 {
     big_integer a("10000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
@@ -564,6 +669,47 @@ TEST(correctness, div_long_signed2)
     EXPECT_EQ(a / b, c);
 }
 
+TEST(correctness, divmod)
+{
+    auto qr = divmod(big_integer(-23), big_integer(5));
+    EXPECT_EQ(qr.first, -4);
+    EXPECT_EQ(qr.second, -3);
+
+    big_integer a("-1000000000000000000000000000000000000000000000000000000000000000000000000007");
+    big_integer b("100000000000000000000000000000000000000");
+    qr = divmod(a, b);
+    EXPECT_EQ(qr.first, big_integer("-10000000000000000000000000000000000000"));
+    EXPECT_EQ(qr.second, -7);
+    EXPECT_EQ(qr.first, a / b);
+    EXPECT_EQ(qr.second, a % b);
+
+    qr = divmod(b, a);
+    EXPECT_EQ(qr.first, 0);
+    EXPECT_EQ(qr.second, b);
+}
+
+TEST(correctness, div_long_top_limb)
+{
+    // 2^128 - 1 and 2^64 - 1: the divisor's top limb needs no normalization
+    big_integer a = (big_integer(1) << 128) - 1;
+    big_integer b = (big_integer(1) << 64) - 1;
+    EXPECT_EQ(a / b, (big_integer(1) << 64) + 1);
+    EXPECT_EQ(a % b, 0);
+    EXPECT_EQ((a - 1) % b, b - 1);
+    EXPECT_EQ(-b / -b, 1);
+    EXPECT_EQ(b / -b, -1);
+}
+
+TEST(correctness, div_long_estimate_correction)
+{
+    // The first quotient digit estimate is too large while the scaled partial
+    // remainder has a zero top limb.
+    big_integer a("730750818835592642601925729365407726414331903999");
+    big_integer b("170141183500083313007266216586365632511");
+    EXPECT_EQ(a / b, big_integer("4294967295"));
+    EXPECT_EQ(a % b, big_integer("170141183460469231768580791867598176254"));
+}
+
 TEST(correctness, negation_long)
 {
     big_integer a( "10000000000000000000000000000000000000000000000000000");
@@ -734,4 +880,1033 @@ TEST(correctness, div_randomized)
         EXPECT_GE(residue, 0);
         EXPECT_LT(residue, divisor);
     }
-}
\ No newline at end of file
+}
+namespace
+{
+    // words random words of LIMB_BITS - 1 bits, so about as many limbs.
+    big_integer random_bits(size_t words)
+    {
+        if (words == 1)
+            return LIMB_BITS == 64 ? (big_integer(rand()) << 32) + rand() : big_integer(rand());
+        size_t low = words / 2;
+        return (random_bits(words - low) << (int) ((LIMB_BITS - 1) * low)) + random_bits(low);
+    }
+}
+
+TEST(correctness, mul_karatsuba_randomized)
+{
+    for (size_t words : {40, 70, 150, 333, 700})
+    {
+        big_integer a = random_bits(words);
+        big_integer b = -random_bits(words + rand() % 20);
+        big_integer c = a * b;
+        EXPECT_EQ(c, b * a);
+        EXPECT_EQ(c / a, b);
+        EXPECT_EQ(c % a, 0);
+        EXPECT_EQ((a + 1) * b - c, b);
+    }
+}
+
+TEST(correctness, mul_unbalanced_randomized)
+{
+    for (size_t words : {100, 250, 600})
+    {
+        big_integer a = random_bits(words * 5 + rand() % 50);
+        big_integer b = random_bits(words);
+        big_integer c = a * b;
+        EXPECT_EQ(c / b, a);
+        EXPECT_EQ(c % b, 0);
+        EXPECT_EQ(a * (b + 7), c + a * 7);
+    }
+}
+
+namespace
+{
+    std::vector<limb_t> random_limbs(size_t n)
+    {
+        std::vector<limb_t> v(n);
+        for (auto& x : v)
+            for (unsigned bits = 0; bits < LIMB_BITS; bits += 16)
+                x = (x << 16u) ^ (limb_t) rand();
+        return v;
+    }
+}
+
+TEST(correctness, mul_kernels_match_schoolbook)
+{
+    size_t const shapes[][2] = {{3, 3}, {3, 2}, {4, 4}, {4, 3}, {4, 2}, {2, 2}};
+    for (size_t n : {7, 40, 97, 300})
+    {
+        for (auto const& shape : shapes)
+        {
+            size_t m = n * shape[1] / shape[0] + 1;
+            auto a = random_limbs(n), b = random_limbs(m);
+            a.back() = 0;
+            std::vector<limb_t> expected(n + m), r(n + m);
+            mul_schoolbook(expected.data(), a.data(), n, b.data(), m);
+            mul_toom(r.data(), a.data(), n, shape[0], b.data(), m, shape[1]);
+            EXPECT_EQ(r, expected);
+            multiply(r.data(), a.data(), n, b.data(), m);
+            EXPECT_EQ(r, expected);
+        }
+    }
+}
+
+TEST(correctness, mul_toom_extreme_limbs)
+{
+    // Full limbs push every point value to its largest size; a zero part next
+    // to full ones makes the values at -1 and -2 negative.
+    size_t const shapes[][2] = {{3, 3}, {3, 2}, {4, 4}, {4, 3}, {4, 2}};
+    for (size_t n : {12, 61, 250})
+    {
+        for (auto const& shape : shapes)
+        {
+            size_t m = n * shape[1] / shape[0];
+            std::vector<limb_t> ones(n, ~limb_t(0)), holes(m, ~limb_t(0));
+            std::fill(holes.begin(), holes.begin() + m / shape[1], 0);
+            std::vector<limb_t> expected(n + m), r(n + m);
+            mul_schoolbook(expected.data(), ones.data(), n, holes.data(), m);
+            mul_toom(r.data(), ones.data(), n, shape[0], holes.data(), m, shape[1]);
+            EXPECT_EQ(r, expected);
+
+            std::vector<limb_t> expected_square(2 * n), square(2 * n);
+            mul_schoolbook(expected_square.data(), ones.data(), n, ones.data(), n);
+            mul_toom(square.data(), ones.data(), n, shape[0], ones.data(), n, shape[0]);
+            EXPECT_EQ(square, expected_square);
+        }
+    }
+}
+
+TEST(correctness, mul_toom_randomized)
+{
+    for (size_t words : {1700, 3300})
+    {
+        big_integer a = random_bits(words);
+        big_integer b = -random_bits(words * 2 / 3);
+        big_integer c = a * b;
+        EXPECT_EQ(c, b * a);
+        for (int p : {1000000007, 998244353, 65537, 3})
+            EXPECT_EQ(c % p, (a % p) * (b % p) % p);
+    }
+}
+
+TEST(correctness, mul_ntt_matches_schoolbook)
+{
+    for (size_t n : {1, 5, 64, 300, 1000})
+    {
+        size_t m = n / 3 + 1;
+        auto a = random_limbs(n), b = random_limbs(m);
+        std::vector<limb_t> expected(n + m), r(n + m);
+        mul_schoolbook(expected.data(), a.data(), n, b.data(), m);
+        mul_ntt(r.data(), a.data(), n, b.data(), m);
+        EXPECT_EQ(r, expected);
+
+        std::vector<limb_t> ones(n, ~limb_t(0)), expected_square(2 * n), square(2 * n);
+        mul_schoolbook(expected_square.data(), ones.data(), n, ones.data(), n);
+        mul_ntt(square.data(), ones.data(), n, ones.data(), n);
+        EXPECT_EQ(square, expected_square);
+    }
+}
+
+TEST(correctness, mul_ntt_aliased_prefix)
+{
+    // The same array as both factors but with different lengths is a product,
+    // not a square.
+    size_t n = NTT_THRESHOLD + 100, m = NTT_THRESHOLD + 7;
+    auto a = random_limbs(n);
+    std::vector<limb_t> expected(n + m), r(n + m);
+    mul_schoolbook(expected.data(), a.data(), n, a.data(), m);
+    mul_ntt(r.data(), a.data(), n, a.data(), m);
+    EXPECT_EQ(r, expected);
+    multiply(r.data(), a.data(), n, a.data(), m);
+    EXPECT_EQ(r, expected);
+}
+
+TEST(correctness, mul_ntt_large)
+{
+    // (2^k - 1)^2 = 2^2k - 2^(k+1) + 1 with every limb of the factors at its maximum
+    int const bits = LIMB_BITS * 20000;
+    big_integer x = (big_integer(1) << bits) - 1;
+    EXPECT_EQ(x * x, (big_integer(1) << (2 * bits)) - (big_integer(1) << (bits + 1)) + 1);
+
+    big_integer a = random_bits(40000);
+    big_integer b = random_bits(30000);
+    big_integer c = a * b;
+    EXPECT_EQ(c, b * a);
+    for (int p : {1000000007, 998244353, 65537})
+        EXPECT_EQ(c % p, (a % p) * (b % p) % p);
+}
+
+TEST(correctness, sqr_kernels_match_schoolbook)
+{
+    for (size_t n : {1, 2, 41, 100, 333})
+    {
+        auto a = random_limbs(n);
+        std::vector<limb_t> expected(2 * n), r(2 * n);
+        mul_schoolbook(expected.data(), a.data(), n, a.data(), n);
+        sqr_schoolbook(r.data(), a.data(), n);
+        EXPECT_EQ(r, expected);
+        if (n >= 2)
+        {
+            sqr_karatsuba(r.data(), a.data(), n);
+            EXPECT_EQ(r, expected);
+        }
+        mul_toom(r.data(), a.data(), n, 3, a.data(), n, 3);
+        EXPECT_EQ(r, expected);
+        mul_ntt(r.data(), a.data(), n, a.data(), n);
+        EXPECT_EQ(r, expected);
+        square(r.data(), a.data(), n);
+        EXPECT_EQ(r, expected);
+    }
+}
+
+TEST(correctness, square)
+{
+    EXPECT_EQ(square(big_integer(-7)), 49);
+    EXPECT_EQ(square(big_integer(0)), 0);
+    for (size_t words : {3, 90, 1000, 2500})
+    {
+        big_integer a = -random_bits(words);
+        big_integer copy = a;
+        big_integer distinct = a + 1;
+        big_integer expected = a * distinct - a;
+        EXPECT_EQ(a * a, expected);
+        EXPECT_EQ(a * copy, expected);
+        EXPECT_EQ(square(a), expected);
+    }
+}
+
+TEST(correctness, div_burnikel_ziegler_randomized)
+{
+    for (size_t words : {320, 451, 900})
+    {
+        big_integer b = random_bits(words);
+        big_integer q = random_bits(words + rand() % 700);
+        big_integer r = random_bits(words - 1);
+        big_integer a = q * b + r;
+        auto qr = divmod(a, b);
+        EXPECT_EQ(qr.first, q);
+        EXPECT_EQ(qr.second, r);
+        qr = divmod(-a, b);
+        EXPECT_EQ(qr.first, -q);
+        EXPECT_EQ(qr.second, -r);
+        EXPECT_EQ(a / -b, -q);
+        EXPECT_EQ(a % -b, r);
+    }
+}
+
+TEST(correctness, div_burnikel_ziegler_saturated_digits)
+{
+    // All-ones limbs make the top halves of the partial remainders equal to
+    // the divisor's, where the quotient digit estimate saturates.
+    for (int limbs : {333, 400})
+    {
+        big_integer b = (big_integer(1) << (int) (LIMB_BITS * limbs)) - 1;
+        big_integer q = (big_integer(1) << (int) (LIMB_BITS * (limbs + 350))) - 1;
+        big_integer a = q * b + (b - 1);
+        auto qr = divmod(a, b);
+        EXPECT_EQ(qr.first, q);
+        EXPECT_EQ(qr.second, b - 1);
+        EXPECT_EQ((a + 1) / b, q + 1);
+        EXPECT_EQ((a + 1) % b, 0);
+    }
+}
+
+namespace
+{
+    size_t limb_count(big_integer const& a)
+    {
+        size_t m = 1;
+        while ((big_integer(1) << (int) (LIMB_BITS * m)) <= a)
+            ++m;
+        return m;
+    }
+}
+
+TEST(correctness, reciprocal_matches_long_division)
+{
+    // A short divisor keeps the reference division on the Knuth path while
+    // the precision takes reciprocal() through several Newton steps.
+    for (size_t words : {1, 3, 100})
+    {
+        big_integer b = random_bits(words) + 1;
+        size_t k = NEWTON_THRESHOLD + 1000;
+        big_integer power = big_integer(1) << (int) (LIMB_BITS * (limb_count(b) + k));
+        EXPECT_EQ(reciprocal(b, k), power / b);
+        EXPECT_EQ(reciprocal(-b, k), -(power / b));
+    }
+}
+
+TEST(correctness, reciprocal_truncated_divisor)
+{
+    size_t k = NEWTON_THRESHOLD + 77;
+    big_integer b = random_bits(k + 500);
+    big_integer power = big_integer(1) << (int) (LIMB_BITS * (limb_count(b) + k));
+    big_integer y = reciprocal(b, k);
+    EXPECT_LE(y * b, power);
+    EXPECT_GT((y + 1) * b, power);
+}
+
+TEST(correctness, div_newton_randomized)
+{
+    for (size_t words : {NEWTON_THRESHOLD * 33 / 31, NEWTON_THRESHOLD * 3 / 2})
+    {
+        big_integer b = random_bits(words);
+        big_integer q = -random_bits(words + 500);
+        big_integer r = random_bits(words / 2);
+        big_integer a = q * b - r;
+        auto qr = divmod(a, b);
+        EXPECT_EQ(qr.first, q);
+        EXPECT_EQ(qr.second, -r);
+        EXPECT_EQ(a / -b, -q);
+        EXPECT_EQ((a - b + r) % b, 0);
+    }
+}
+
+TEST(correctness, big_divisor_small)
+{
+    big_divisor seven(7);
+    EXPECT_EQ(seven.div(-23), -3);
+    EXPECT_EQ(seven.mod(-23), -2);
+    EXPECT_EQ(seven.divisor(), 7);
+    EXPECT_EQ(big_divisor(-7).divmod(23), std::make_pair(big_integer(-3), big_integer(2)));
+    EXPECT_EQ(seven.divmod(0), std::make_pair(big_integer(0), big_integer(0)));
+
+    big_integer top_bit = big_integer(1) << (int) (LIMB_BITS - 1);
+    EXPECT_EQ(big_divisor(top_bit).divmod(top_bit * 5 + 3), std::make_pair(big_integer(5), big_integer(3)));
+}
+
+TEST(correctness, big_divisor_matches_divmod)
+{
+    std::vector<size_t> sizes = {1, 2, 3, 5, 40, BURNIKEL_ZIEGLER_THRESHOLD + 7, BARRETT_THRESHOLD * 33 / 31,
+                                 BARRETT_THRESHOLD * 2};
+    for (size_t words : sizes)
+    {
+        big_integer b = random_bits(words) + 1;
+        big_divisor prepared(b);
+        for (size_t length : {words / 2 + 1, words, words + 1, 2 * words + 3, 5 * words})
+        {
+            big_integer a = random_bits(length);
+            EXPECT_EQ(prepared.divmod(a), divmod(a, b));
+            EXPECT_EQ(prepared.div(-a), -a / b);
+            EXPECT_EQ(prepared.mod(-a), -a % b);
+        }
+        big_integer all_ones = (big_integer(1) << (int) (LIMB_BITS * limb_count(b) * 3)) - 1;
+        EXPECT_EQ(prepared.divmod(all_ones), divmod(all_ones, b));
+    }
+    // The top limbs of dividend and divisor agree, so the first quotient
+    // digit is estimated as B - 1 without a division.
+    big_integer top = (big_integer(1) << (int) (LIMB_BITS * 3)) - 5;
+    big_integer a = (top << (int) LIMB_BITS) - 1;
+    EXPECT_EQ(big_divisor(top).divmod(a), std::make_pair(a / top, a % top));
+    EXPECT_EQ(a / top, (big_integer(1) << (int) LIMB_BITS) - 1);
+}
+
+TEST(correctness, montgomery_context)
+{
+    for (size_t words : {1, 2, 5, 70})
+    {
+        big_integer n = random_bits(words) * 2 + 3;
+        montgomery_context context(n);
+        EXPECT_EQ(context.modulus(), n);
+        EXPECT_EQ(context.from_montgomery(context.one()), 1);
+        for (int i = 0; i < 5; ++i)
+        {
+            big_integer a = random_bits(words + 3) % n, b = -random_bits(words + 1);
+            big_integer b_reduced = (b % n + n) % n;
+            big_integer x = context.to_montgomery(a), y = context.to_montgomery(b);
+            EXPECT_EQ(context.from_montgomery(x), a);
+            EXPECT_EQ(context.from_montgomery(y), b_reduced);
+            EXPECT_EQ(context.from_montgomery(context.mul(x, y)), a * b_reduced % n);
+            EXPECT_EQ(context.from_montgomery(context.sqr(x)), a * a % n);
+            EXPECT_EQ(context.from_montgomery(context.add(x, y)), (a + b_reduced) % n);
+            EXPECT_EQ(context.from_montgomery(context.sub(x, y)), ((a - b_reduced) % n + n) % n);
+
+            big_integer power = 1;
+            for (int k = 0; k < 40; ++k)
+                power = power * a % n;
+            EXPECT_EQ(context.from_montgomery(context.pow(x, 40)), power);
+            EXPECT_EQ(context.pow(x, 0), context.one());
+        }
+    }
+}
+
+TEST(correctness, montgomery_fermat)
+{
+    // 2^127 - 1 is prime, so a^(p - 1) = 1 for every a not divisible by p.
+    big_integer p = (big_integer(1) << 127) - 1;
+    montgomery_context context(p);
+    big_integer a = context.to_montgomery(big_integer("123456789012345678901234567890"));
+    EXPECT_EQ(context.from_montgomery(context.pow(a, p - 1)), 1);
+    EXPECT_EQ(context.mul(context.pow(a, p - 2), a), context.one());
+}
+
+TEST(correctness, powmod)
+{
+    EXPECT_EQ(powmod(3, 200, 1000), 1);
+    EXPECT_EQ(powmod(-2, 3, 7), 6);
+    EXPECT_EQ(powmod(5, 0, 7), 1);
+    EXPECT_EQ(powmod(5, 0, 1), 0);
+    EXPECT_EQ(powmod(0, 5, 12), 0);
+    EXPECT_EQ(powmod_constant_time(-2, 3, 7), 6);
+    EXPECT_EQ(powmod_constant_time(5, 0, 8), 1);
+
+    big_integer p = (big_integer(1) << 521) - 1;
+    big_integer a("98765432109876543210987654321098765432109876543210");
+    EXPECT_EQ(powmod(a, p - 1, p), 1);
+    EXPECT_EQ(powmod_constant_time(a, p - 1, p), 1);
+    EXPECT_EQ(powmod(a, p - 2, p) * a % p, 1);
+}
+
+TEST(correctness, powmod_constant_time_extreme_residues)
+{
+    // Moduli just under and just over a limb boundary make the intermediate
+    // values use all n + 1 limbs, or leave the top limbs of residues zero.
+    big_integer below = (big_integer(1) << (int) (LIMB_BITS * 3)) - 1;
+    big_integer above = (big_integer(1) << (int) (LIMB_BITS * 3)) + 1;
+    for (big_integer modulus : {below, above, below - 1, above + 1})
+    {
+        for (big_integer a : {modulus - 1, modulus - 2, big_integer(2), random_bits(5)})
+        {
+            big_integer e = random_bits(2) + 3;
+            EXPECT_EQ(powmod_constant_time(a, e, modulus), powmod(a, e, modulus));
+        }
+        EXPECT_EQ(powmod_constant_time(modulus - 1, 5, modulus), modulus - 1);
+    }
+}
+
+TEST(correctness, powmod_matches_repeated_multiplication)
+{
+    for (size_t words : {1, 3, 40})
+    {
+        for (big_integer modulus : {random_bits(words) * 2 + 1, random_bits(words) * 6 + 2})
+        {
+            big_integer a = random_bits(words + 2);
+            big_integer expected = 1;
+            for (int e = 0; e <= 70; ++e)
+            {
+                EXPECT_EQ(powmod(a, e, modulus), expected);
+                EXPECT_EQ(powmod_constant_time(a, e, modulus), expected);
+                expected = expected * a % modulus;
+            }
+
+            big_integer e = random_bits(30);
+            big_integer x = powmod(a, e, modulus);
+            EXPECT_EQ(powmod_constant_time(a, e, modulus), x);
+            EXPECT_EQ(powmod(a, e + 1, modulus), x * a % modulus);
+            EXPECT_EQ(powmod(a, e * 2, modulus), x * x % modulus);
+        }
+    }
+}
+
+TEST(correctness, pow)
+{
+    EXPECT_EQ(pow(big_integer(0), 0), 1);
+    EXPECT_EQ(pow(big_integer(0), 5), 0);
+    EXPECT_EQ(pow(big_integer(-1), 7), -1);
+    EXPECT_EQ(pow(big_integer(-1), 8), 1);
+    EXPECT_EQ(pow(big_integer(10), 30), big_integer("1000000000000000000000000000000"));
+    EXPECT_EQ(pow(big_integer(-3), 5), -243);
+    EXPECT_EQ(pow(big_integer(2), 100), big_integer(1) << 100);
+    EXPECT_EQ(pow(big_integer(-8), 3), -512);
+    EXPECT_EQ(pow(-(big_integer(1) << 70), 5), -(big_integer(1) << 350));
+
+    // Results past INT_MAX bits are refused rather than shifted or allocated.
+    EXPECT_THROW(pow(big_integer(2), uint64_t(1) << 40), std::length_error);
+    EXPECT_THROW(pow(big_integer(1) << 1000, uint64_t(1) << 22), std::length_error);
+    EXPECT_THROW(pow(big_integer(3), UINT64_MAX), std::length_error);
+    EXPECT_THROW(pow(big_integer(10), uint64_t(1) << 31), std::length_error);
+
+    for (size_t words : {1, 4, 30})
+    {
+        big_integer a = -random_bits(words);
+        big_integer expected = 1;
+        for (uint64_t e = 0; e <= 40; ++e)
+        {
+            EXPECT_EQ(pow(a, e), expected);
+            expected *= a;
+        }
+    }
+}
+
+TEST(correctness, to_string_long)
+{
+    // Zero runs across the boundaries of the power-of-ten split.
+    for (unsigned k : {8, 9, 10, 18, 100, 1000, 5000})
+    {
+        std::string ones = "1" + std::string(k - 1, '0') + "1";
+        EXPECT_EQ(to_string(pow(big_integer(10), k) + 1), ones);
+        EXPECT_EQ(to_string(-pow(big_integer(10), k)), "-1" + std::string(k, '0'));
+        EXPECT_EQ(to_string(pow(big_integer(10), k) - 1), std::string(k, '9'));
+    }
+    for (size_t words : {20, 300, 2000})
+    {
+        big_integer a = -random_bits(words);
+        std::string s = to_string(a);
+        EXPECT_EQ(big_integer(s), a);
+        EXPECT_EQ(to_string(a * pow(big_integer(10), 77)), s + std::string(77, '0'));
+    }
+}
+
+TEST(correctness, parse_long)
+{
+    for (size_t length : {1, 9, 10, 359, 360, 361, 2000, 5000})
+    {
+        std::string s;
+        big_integer expected = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            s += (char) ('0' + rand() % 10);
+            expected = expected * 10 + (s.back() - '0');
+        }
+        EXPECT_EQ(big_integer(s), expected);
+        EXPECT_EQ(big_integer("-" + s), -expected);
+        EXPECT_EQ(big_integer(std::string(length, '0') + s), expected);
+    }
+    EXPECT_EQ(big_integer("1" + std::string(3000, '0')), pow(big_integer(10), 3000));
+    EXPECT_EQ(big_integer("-" + std::string(3000, '0')), 0);
+
+    big_integer a = random_bits(10000);
+    EXPECT_EQ(big_integer(to_string(a)), a);
+}
+
+TEST(correctness, radix_power_cache)
+{
+    size_t chunk = radix_chunk_digits(10);
+    EXPECT_EQ(chunk, LIMB_BITS == 64 ? 19u : 9u);
+    EXPECT_EQ(radix_chunk_digits(2), LIMB_BITS - 1);
+    EXPECT_EQ(radix_chunk_digits(36), LIMB_BITS == 64 ? 12u : 6u);
+
+    radix_power_cache& cache = radix_power_cache::instance();
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.power(10, 3), pow(big_integer(10), 8 * chunk));
+    EXPECT_EQ(cache.size(), 15u);
+    EXPECT_EQ(cache.power(7, 0), pow(big_integer(7), radix_chunk_digits(7)));
+
+    size_t limit = cache.limit();
+    cache.clear();
+    cache.set_limit(7);
+    EXPECT_EQ(cache.power(10, 5), pow(big_integer(10), 32 * chunk));
+    EXPECT_EQ(cache.size(), 7u);
+    std::vector<big_integer> powers = cache.powers(10, 4);
+    EXPECT_EQ(powers.size(), 4u);
+    EXPECT_EQ(powers[3], pow(big_integer(10), 8 * chunk));
+    cache.power(2, 1);
+    EXPECT_EQ(cache.size(), 7u);
+    cache.set_limit(3);
+    EXPECT_EQ(cache.size(), 3u);
+    cache.set_limit(2);
+    EXPECT_EQ(cache.size(), 1u);
+    cache.set_limit(0);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.power(10, 2), pow(big_integer(10), 4 * chunk));
+    cache.set_limit(limit);
+    cache.clear();
+}
+
+TEST(correctness, radix_power_cache_threads)
+{
+    radix_power_cache::instance().clear();
+    std::vector<big_integer> values;
+    std::vector<std::string> expected;
+    for (size_t words : {500, 700, 900, 1100})
+    {
+        values.push_back(random_bits(words));
+        expected.push_back(to_string(values.back()));
+    }
+    radix_power_cache::instance().clear();
+
+    std::vector<std::string> printed(values.size());
+    std::vector<big_integer> parsed(values.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < values.size(); ++i)
+        threads.emplace_back([&, i] {
+            printed[i] = to_string(values[i]);
+            parsed[i] = big_integer(expected[i]);
+        });
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(printed, expected);
+    EXPECT_EQ(parsed, values);
+}
+
+TEST(correctness, to_string_base)
+{
+    EXPECT_EQ(big_integer(255).to_string(16), "ff");
+    EXPECT_EQ(big_integer(-255).to_string(2), "-11111111");
+    EXPECT_EQ(big_integer(0).to_string(7), "0");
+    EXPECT_EQ(big_integer(8).to_string(8), "10");
+    EXPECT_EQ(to_string(big_integer(35), 36), "z");
+    EXPECT_EQ(to_string(big_integer(-36 * 36), 36), "-100");
+    EXPECT_EQ((big_integer(1) << 100).to_string(32), "1" + std::string(20, '0'));
+    EXPECT_EQ(((big_integer(1) << 97) - 1).to_string(8), "1" + std::string(32, '7'));
+    EXPECT_EQ(pow(big_integer(3), 500).to_string(3), "1" + std::string(500, '0'));
+    EXPECT_EQ((pow(big_integer(7), 2000) - 1).to_string(7), std::string(2000, '6'));
+}
+
+TEST(correctness, from_string_base)
+{
+    EXPECT_EQ(from_string("ff", 16), 255);
+    EXPECT_EQ(from_string("-FF", 16), -255);
+    EXPECT_EQ(from_string("+777", 8), 511);
+    EXPECT_EQ(from_string("-0", 2), 0);
+    EXPECT_EQ(from_string("Zz", 36), 36 * 36 - 1);
+    EXPECT_EQ(from_string("00000000000000000000000000000000000000001", 16), 1);
+    EXPECT_EQ(from_string("1" + std::string(40, '0'), 16), big_integer(1) << 160);
+
+    for (int base = 2; base <= 36; ++base)
+    {
+        for (size_t words : {1, 5, 200, 1500})
+        {
+            big_integer a = -random_bits(words);
+            std::string s = a.to_string(base);
+            EXPECT_EQ(from_string(s, base), a) << base;
+            if (words == 5)
+            {
+                big_integer expected = 0;
+                for (size_t i = 1; i < s.size(); ++i)
+                    expected = expected * base + from_string(std::string(1, s[i]), base);
+                EXPECT_EQ(-expected, a) << base;
+            }
+        }
+    }
+}
+
+TEST(correctness, to_chars)
+{
+    char buffer[64];
+    auto result = to_chars(buffer, buffer + sizeof buffer, big_integer(-1234));
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(std::string(buffer, result.ptr), "-1234");
+    result = to_chars(buffer, buffer + 5, big_integer(-1234));
+    EXPECT_EQ(std::string(buffer, result.ptr), "-1234");
+    result = to_chars(buffer, buffer + 4, big_integer(-1234));
+    EXPECT_EQ(result.ec, std::errc::value_too_large);
+    EXPECT_EQ(result.ptr, buffer + 4);
+    result = to_chars(buffer, buffer + 1, big_integer(0), 16);
+    EXPECT_EQ(std::string(buffer, result.ptr), "0");
+
+    EXPECT_EQ(max_chars(big_integer(0), 10), 1u);
+    EXPECT_EQ(max_chars(big_integer(-255), 16), 3u);
+    EXPECT_EQ(max_chars(big_integer(1000), 10), 4u);
+
+    // max_chars() is one over for these, and the digits still fit.
+    EXPECT_EQ(max_chars(big_integer(-999), 10), 5u);
+    result = to_chars(buffer, buffer + 4, big_integer(-999));
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(std::string(buffer, result.ptr), "-999");
+    EXPECT_EQ(to_chars(buffer, buffer + 3, big_integer(-999)).ec, std::errc::value_too_large);
+    big_integer nines = pow(big_integer(10), 700) - 1;
+    ASSERT_EQ(max_chars(nines, 10), 701u);
+    std::vector<char> digits(700);
+    result = to_chars(digits.data(), digits.data() + digits.size(), nines);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(std::string(digits.data(), result.ptr), std::string(700, '9'));
+
+    for (int base : {2, 3, 10, 16, 36})
+    {
+        for (size_t words : {1, 3, 50, 1000})
+        {
+            big_integer a = -random_bits(words);
+            std::string expected = a.to_string(base);
+            size_t bound = max_chars(a, base);
+            EXPECT_GE(bound, expected.size());
+            EXPECT_LE(bound, expected.size() + 1);
+            std::vector<char> out(expected.size());
+            result = to_chars(out.data(), out.data() + out.size(), a, base);
+            EXPECT_EQ(result.ec, std::errc());
+            EXPECT_EQ(std::string(out.data(), result.ptr), expected);
+            EXPECT_EQ(to_chars(out.data(), out.data() + out.size() - 1, a, base).ec, std::errc::value_too_large);
+        }
+    }
+}
+
+TEST(correctness, from_chars)
+{
+    big_integer value = 7;
+    std::string s = "-12ab";
+    auto result = from_chars(s.data(), s.data() + s.size(), value);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(result.ptr, s.data() + 3);
+    EXPECT_EQ(value, -12);
+    result = from_chars(s.data(), s.data() + s.size(), value, 16);
+    EXPECT_EQ(result.ptr, s.data() + s.size());
+    EXPECT_EQ(value, -0x12ab);
+
+    for (std::string bad : {"", "-", "+5", " 5", "x"})
+    {
+        value = 7;
+        result = from_chars(bad.data(), bad.data() + bad.size(), value);
+        EXPECT_EQ(result.ec, std::errc::invalid_argument);
+        EXPECT_EQ(result.ptr, bad.data());
+        EXPECT_EQ(value, 7);
+    }
+
+    big_integer a = random_bits(2000);
+    s = a.to_string(36) + "!";
+    result = from_chars(s.data(), s.data() + s.size(), value, 36);
+    EXPECT_EQ(result.ptr, s.data() + s.size() - 1);
+    EXPECT_EQ(value, a);
+}
+
+TEST(correctness, stream_input)
+{
+    std::istringstream in("  123\n-456 +7 12abc");
+    big_integer a, b, c, d;
+    in >> a >> b >> c >> d;
+    EXPECT_EQ(a, 123);
+    EXPECT_EQ(b, -456);
+    EXPECT_EQ(c, 7);
+    EXPECT_EQ(d, 12);
+    std::string rest;
+    EXPECT_TRUE(static_cast<bool>(in >> rest));
+    EXPECT_EQ(rest, "abc");
+    EXPECT_TRUE(in.eof());
+
+    std::istringstream hex("ff -0x1F 0 0x");
+    hex >> std::hex >> a >> b >> c;
+    EXPECT_EQ(a, 255);
+    EXPECT_EQ(b, -31);
+    EXPECT_EQ(c, 0);
+    EXPECT_FALSE(static_cast<bool>(hex >> d));
+
+    std::istringstream oct("-777");
+    oct >> std::oct >> a;
+    EXPECT_EQ(a, -511);
+    EXPECT_TRUE(oct.eof());
+    EXPECT_FALSE(oct.fail());
+
+    for (std::string bad : {"-", "+ 5", "abc", "--1"})
+    {
+        std::istringstream failing(bad);
+        a = 5;
+        EXPECT_FALSE(static_cast<bool>(failing >> a)) << bad;
+        EXPECT_EQ(a, 0);
+    }
+    std::istringstream blank("   ");
+    EXPECT_FALSE(static_cast<bool>(blank >> a));
+    EXPECT_EQ(a, 0);
+}
+
+TEST(correctness, stream_input_long)
+{
+    for (size_t words : {600, 5000})
+    {
+        big_integer expected = -random_bits(words);
+        for (int base : {10, 16, 8})
+        {
+            std::ostringstream text;
+            std::string digits = expected.to_string(base);
+            text << "  " << digits << " tail";
+            std::istringstream in(text.str());
+            in.setf(base == 16 ? std::ios_base::hex : base == 8 ? std::ios_base::oct : std::ios_base::dec,
+                    std::ios_base::basefield);
+            big_integer a;
+            EXPECT_TRUE(static_cast<bool>(in >> a));
+            EXPECT_EQ(a, expected) << base;
+        }
+    }
+}
+
+TEST(correctness, stream_output_format)
+{
+    big_integer a("-255");
+    std::ostringstream out;
+    out << a;
+    EXPECT_EQ(out.str(), "-255");
+
+    out.str("");
+    out << std::hex << a << ' ' << std::showbase << std::uppercase << big_integer(255);
+    EXPECT_EQ(out.str(), "-ff 0XFF");
+
+    out.str("");
+    out.flags(std::ios_base::fmtflags());
+    out << std::oct << std::showbase << big_integer(8) << ' ' << big_integer(0);
+    EXPECT_EQ(out.str(), "010 0");
+
+    std::ostringstream expected;
+    expected << std::showbase << std::hex << 0 << ' ' << 255;
+    out.str("");
+    out.flags(std::ios_base::fmtflags());
+    out << std::showbase << std::hex << big_integer(0) << ' ' << big_integer(255);
+    EXPECT_EQ(out.str(), expected.str());
+    EXPECT_EQ(out.str(), "0 0xff");
+
+    out.str("");
+    out.flags(std::ios_base::fmtflags());
+    out << std::showpos << big_integer(7) << ' ' << big_integer(0) << ' ' << big_integer(-7);
+    EXPECT_EQ(out.str(), "+7 +0 -7");
+}
+
+TEST(correctness, stream_output_padding)
+{
+    std::ostringstream out;
+    out << std::setw(6) << big_integer(-42) << '|' << big_integer(1);
+    EXPECT_EQ(out.str(), "   -42|1");
+
+    out.str("");
+    out << std::left << std::setfill('*') << std::setw(6) << big_integer(-42);
+    EXPECT_EQ(out.str(), "-42***");
+
+    out.str("");
+    out << std::internal << std::hex << std::showbase << std::setfill('0') << std::setw(8) << big_integer(-42);
+    EXPECT_EQ(out.str(), "-0x0002a");
+
+    out.str("");
+    out.flags(std::ios_base::fmtflags());
+    out << std::setfill('.') << std::setw(1000) << big_integer(5);
+    EXPECT_EQ(out.str(), std::string(999, '.') + "5");
+}
+
+TEST(correctness, stream_output_long)
+{
+    big_integer a = -random_bits(3000);
+    std::ostringstream out;
+    out << a << std::hex << ' ' << a;
+    EXPECT_EQ(out.str(), to_string(a) + " " + a.to_string(16));
+}
+
+// Records the largest single write it is handed.
+struct largest_write_buffer : std::stringbuf
+{
+    std::streamsize largest = 0;
+
+    std::streamsize xsputn(char const* s, std::streamsize n) override
+    {
+        largest = std::max(largest, n);
+        return std::stringbuf::xsputn(s, n);
+    }
+};
+
+TEST(correctness, stream_output_chunks)
+{
+    // 10^20000 + 7 leaves long zero runs in the padded lower parts.
+    for (big_integer x : {pow(big_integer(10), 20000) + 7, -random_bits(3000)})
+    {
+        largest_write_buffer buffer;
+        std::ostream out(&buffer);
+        out << std::setfill('#') << std::setw(100000) << x;
+        std::string digits = to_string(x);
+        EXPECT_EQ(buffer.str(), std::string(100000 - digits.size(), '#') + digits);
+        EXPECT_LT(buffer.largest, 4096);
+    }
+}
+
+TEST(correctness, export_bytes_layouts)
+{
+    big_integer a = from_string("0102030405060708090a", 16);
+    unsigned char out[16];
+    EXPECT_EQ(export_words(a, 1), 10u);
+    EXPECT_EQ(export_words(a, 4), 3u);
+
+    EXPECT_EQ(export_bytes(out, a, 1, endian::big, endian::little), 10u);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(out[i], i + 1);
+
+    EXPECT_EQ(export_bytes(out, a, 4, endian::little, endian::little), 3u);
+    unsigned char little[12] = {10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0};
+    EXPECT_TRUE(std::equal(out, out + 12, little));
+
+    EXPECT_EQ(export_bytes(out, a, 4, endian::big, endian::big), 3u);
+    unsigned char big[12] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    EXPECT_TRUE(std::equal(out, out + 12, big));
+
+    EXPECT_EQ(export_bytes(out, a, 4, endian::little, endian::big), 3u);
+    unsigned char mixed[12] = {7, 8, 9, 10, 3, 4, 5, 6, 0, 0, 1, 2};
+    EXPECT_TRUE(std::equal(out, out + 12, mixed));
+
+    for (endian order : {endian::little, endian::big, endian::native})
+        for (endian byte_order : {endian::little, endian::big, endian::native})
+        {
+            size_t count = export_bytes(out, a, 4, order, byte_order);
+            EXPECT_EQ(import_bytes(out, count, 4, order, byte_order), a);
+        }
+
+    EXPECT_EQ(export_words(0, 8), 0u);
+    EXPECT_EQ(import_bytes(out, 0, 8, endian::big, endian::big), 0);
+    EXPECT_EQ(export_bytes(out, -a, 1, endian::big, endian::big), 10u);
+    EXPECT_EQ(out[0], 1);
+}
+
+TEST(correctness, export_bytes_twos_complement)
+{
+    unsigned char out[16];
+    EXPECT_EQ(export_words(127, 1, sign_format::twos_complement), 1u);
+    EXPECT_EQ(export_words(128, 1, sign_format::twos_complement), 2u);
+    EXPECT_EQ(export_words(-128, 1, sign_format::twos_complement), 1u);
+    EXPECT_EQ(export_words(-129, 1, sign_format::twos_complement), 2u);
+    EXPECT_EQ(export_words(0, 1, sign_format::twos_complement), 1u);
+
+    EXPECT_EQ(export_bytes(out, -2, 2, endian::big, endian::big, sign_format::twos_complement), 1u);
+    EXPECT_EQ(out[0], 0xff);
+    EXPECT_EQ(out[1], 0xfe);
+
+    EXPECT_EQ(import_bytes(out, 1, 2, endian::big, endian::big, sign_format::twos_complement), -2);
+    EXPECT_EQ(import_bytes(out, 1, 2, endian::big, endian::big), 0xfffe);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        big_integer a = random_bits(1 + i % 7);
+        if (i % 2)
+            a = -a;
+        if (i % 3 == 0)
+            a = (i % 2 ? -big_integer(1) : big_integer(1)) << (32 * (i % 5));
+        for (size_t word_size : {1, 3, 4, 8})
+            for (endian order : {endian::little, endian::big})
+            {
+                std::vector<unsigned char> buffer(word_size * export_words(a, word_size, sign_format::twos_complement));
+                size_t count = export_bytes(buffer.data(), a, word_size, order, endian::little,
+                                            sign_format::twos_complement);
+                EXPECT_EQ(count * word_size, buffer.size());
+                EXPECT_EQ(import_bytes(buffer.data(), count, word_size, order, endian::little,
+                                       sign_format::twos_complement), a);
+            }
+    }
+}
+
+TEST(correctness, serialize_round_trip)
+{
+    std::vector<big_integer> values = {0, 1, -1, 255, -256, big_integer(1) << 1000};
+    for (int i = 0; i < 50; ++i)
+        values.push_back(i % 2 ? -random_bits(1 + 3 * i) : random_bits(1 + 3 * i));
+
+    std::vector<unsigned char> buffer;
+    for (big_integer const& a : values)
+    {
+        size_t offset = buffer.size();
+        buffer.resize(offset + serialized_size(a));
+        EXPECT_EQ(serialize(buffer.data() + offset, a), buffer.data() + buffer.size());
+    }
+    unsigned char const* p = buffer.data();
+    for (big_integer const& a : values)
+    {
+        big_integer b;
+        p = deserialize(p, buffer.data() + buffer.size(), b);
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(b, a);
+    }
+    EXPECT_EQ(p, buffer.data() + buffer.size());
+
+    unsigned char small[8];
+    EXPECT_EQ(serialize(small, -258) - small, 4);
+    unsigned char expected[4] = {SERIALIZATION_VERSION, 5, 2, 1};
+    EXPECT_TRUE(std::equal(small, small + 4, expected));
+}
+
+TEST(correctness, deserialize_rejects_malformed)
+{
+    big_integer value = 7;
+    auto rejects = [&](std::vector<unsigned char> bytes)
+    {
+        return deserialize(bytes.data(), bytes.data() + bytes.size(), value) == nullptr;
+    };
+    EXPECT_TRUE(rejects({}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION + 1, 0}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION, 4, 1}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION, 2, 0}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION, 1}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION, 0x82, 0}));
+    EXPECT_TRUE(rejects({SERIALIZATION_VERSION, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f}));
+    EXPECT_EQ(value, 7);
+    EXPECT_FALSE(rejects({SERIALIZATION_VERSION, 0}));
+    EXPECT_EQ(value, 0);
+}
+
+TEST(correctness, view_compare_and_arithmetic)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        big_integer a = random_bits(1 + i % 9), b = random_bits(1 + i % 5);
+        if (i % 2)
+            a = -a;
+        if (i % 3)
+            b = -b;
+        if (i % 7 == 0)
+            b = a;
+        if (i % 11 == 0)
+            b = 0;
+        big_integer_view va = a, vb = b;
+        EXPECT_EQ(va == vb, a == b);
+        EXPECT_EQ(va < vb, (a - b).to_string()[0] == '-');
+        EXPECT_EQ(va >= vb, !(va < vb));
+        EXPECT_EQ(va + vb, a + b);
+        EXPECT_EQ(va - vb, a - b);
+        EXPECT_EQ(va * vb, a * b);
+        EXPECT_EQ(va * va, a * a);
+        EXPECT_EQ(va.to_big_integer(), a);
+        EXPECT_EQ(-va, -a);
+    }
+    limb_t limbs[3] = {5, 0, 0};
+    EXPECT_EQ(big_integer_view(true, limbs, 3), big_integer(-5));
+    EXPECT_EQ(big_integer_view(true, limbs, 3).size(), 1u);
+    EXPECT_FALSE(big_integer_view(true, limbs, 0).negative());
+    EXPECT_EQ(big_integer_view(true, limbs, 0), big_integer(0));
+}
+
+namespace
+{
+    // A new empty file under the temporary directory, unique to this run so
+    // that concurrent test binaries do not overwrite each other's tables.
+    std::string temporary_path()
+    {
+        char const* dir = std::getenv("TMPDIR");
+        std::string path = std::string(dir && *dir ? dir : "/tmp") + "/big_integer_table_XXXXXX";
+        int fd = mkstemp(&path[0]);
+        assert(fd >= 0);
+        close(fd);
+        return path;
+    }
+}
+
+TEST(correctness, table_round_trip)
+{
+    std::vector<big_integer> values = {0, -1, big_integer(1) << 100};
+    for (int i = 0; i < 100; ++i)
+        values.push_back(i % 3 ? random_bits(1 + i) : -random_bits(1 + i));
+    std::string path = temporary_path();
+    big_integer_table::write(path, values);
+    {
+        big_integer_table table(path);
+        ASSERT_EQ(table.size(), values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            EXPECT_EQ(table[i], values[i]);
+            EXPECT_EQ(table[i] + values[0], values[i]);
+        }
+        big_integer_table moved = std::move(table);
+        EXPECT_EQ(moved[3] * moved[4], values[3] * values[4]);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(correctness, table_rejects_bad_files)
+{
+    std::string path = temporary_path();
+    EXPECT_THROW(big_integer_table("no/such/big_integer_table.bin"), std::system_error);
+    {
+        std::ofstream out(path, std::ios_base::binary);
+        out << "not a table, but long enough to have a header";
+    }
+    EXPECT_THROW(big_integer_table{path}, std::runtime_error);
+
+    big_integer_table::write(path, {big_integer(1) << 200});
+    std::string content;
+    {
+        std::ifstream in(path, std::ios_base::binary);
+        content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios_base::binary);
+        out.write(content.data(), 30);
+    }
+    EXPECT_THROW(big_integer_table{path}, std::runtime_error);
+    {
+        std::ofstream out(path, std::ios_base::binary);
+        out.write(content.data(), (std::streamsize) content.size() - 8);
+    }
+    big_integer_table truncated(path);
+    EXPECT_THROW(truncated[0], std::runtime_error);
+    std::remove(path.c_str());
+}